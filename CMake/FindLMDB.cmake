@@ -0,0 +1,25 @@
+# - Try to find LMDB
+# Once done, this will define
+#
+#  LMDB_FOUND - system has LMDB
+#  LMDB_INCLUDE_DIRS - the LMDB include directories
+#  LMDB_LIBRARIES - the LMDB library
+find_package(PkgConfig)
+
+pkg_check_modules(LMDB_PKGCONF lmdb)
+
+find_path(LMDB_INCLUDE_DIRS
+  NAMES lmdb.h
+  PATHS ${LMDB_PKGCONF_INCLUDE_DIRS}
+)
+
+
+find_library(LMDB_LIBRARIES
+  NAMES lmdb
+  PATHS ${LMDB_PKGCONF_LIBRARY_DIRS}
+)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(LMDB DEFAULT_MSG LMDB_INCLUDE_DIRS LMDB_LIBRARIES)
+
+mark_as_advanced(LMDB_INCLUDE_DIRS LMDB_LIBRARIES)
@@ -47,14 +47,25 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
 #include <apti18n.h>
 									/*}}}*/
 
 using namespace std;
 
+static bool DebugTransaction()						/*{{{*/
+{
+   static Configuration::Key const Debug("Debug::Acquire::Transaction");
+   return _config->FindB(Debug, false);
+}
+									/*}}}*/
 static std::string GetPartialFileName(std::string const &file)		/*{{{*/
 {
    std::string DestFile = _config->FindDir("Dir::State::lists") + "partial/";
@@ -409,7 +420,7 @@ bool pkgAcqTransactionItem::QueueURI(pkgAcquire::ItemDesc &Item)
 {
    if (TransactionManager->State != TransactionStarted)
    {
-      if (_config->FindB("Debug::Acquire::Transaction", false))
+      if (DebugTransaction())
 	 std::clog << "Skip " << Target.URI << " as transaction was already dealt with!" << std::endl;
       return false;
    }
@@ -557,7 +568,7 @@ std::string pkgAcqDiffIndex::GetMetaKey() const
 //pkgAcqTransactionItem::TransactionState and specialisations for child classes	/*{{{*/
 bool pkgAcqTransactionItem::TransactionState(TransactionStates const state)
 {
-   bool const Debug = _config->FindB("Debug::Acquire::Transaction", false);
+   bool const Debug = DebugTransaction();
    switch(state)
    {
       case TransactionStarted: _error->Fatal("Item %s changed to invalid transaction start state!", Target.URI.c_str()); break;
@@ -756,7 +767,7 @@ class APT_HIDDEN CleanupItem : public pkgAcqTransactionItem		/*{{{*/
 	 case TransactionAbort:
 	    break;
 	 case TransactionCommit:
-	    if (_config->FindB("Debug::Acquire::Transaction", false) == true)
+	    if (DebugTransaction() == true)
 	       std::clog << "rm " << DestFile << " # " << DescURI() << std::endl;
 	    if (RemoveFile("TransItem::TransactionCommit", DestFile) == false)
 	       return false;
@@ -1240,7 +1251,7 @@ void pkgAcqMetaBase::Add(pkgAcqTransactionItem * const I)
 // AcqMetaBase::AbortTransaction - Abort the current Transaction	/*{{{*/
 void pkgAcqMetaBase::AbortTransaction()
 {
-   if(_config->FindB("Debug::Acquire::Transaction", false) == true)
+   if(DebugTransaction() == true)
       std::clog << "AbortTransaction: " << TransactionManager << std::endl;
 
    switch (TransactionManager->State)
@@ -1285,7 +1296,7 @@ APT_PURE bool pkgAcqMetaBase::TransactionHasError() const
 // AcqMetaBase::CommitTransaction - Commit a transaction		/*{{{*/
 void pkgAcqMetaBase::CommitTransaction()
 {
-   if(_config->FindB("Debug::Acquire::Transaction", false) == true)
+   if(DebugTransaction() == true)
       std::clog << "CommitTransaction: " << this << std::endl;
 
    switch (TransactionManager->State)
@@ -1909,7 +1920,7 @@ string pkgAcqMetaClearSig::Custom600Headers() const
 									/*}}}*/
 void pkgAcqMetaClearSig::Finished()					/*{{{*/
 {
-   if(_config->FindB("Debug::Acquire::Transaction", false) == true)
+   if(DebugTransaction() == true)
       std::clog << "Finished: " << DestFile <<std::endl;
    if(TransactionManager->State == TransactionStarted &&
       TransactionManager->TransactionHasError() == false)
@@ -2041,7 +2052,7 @@ pkgAcqMetaIndex::pkgAcqMetaIndex(pkgAcquire * const Owner,		/*{{{*/
    pkgAcqMetaBase(Owner, TransactionManager, DataTarget), d(NULL),
    DetachedSigTarget(DetachedSigTarget)
 {
-   if(_config->FindB("Debug::Acquire::Transaction", false) == true)
+   if(DebugTransaction() == true)
       std::clog << "New pkgAcqMetaIndex with TransactionManager "
                 << this->TransactionManager << std::endl;
 
@@ -2124,7 +2135,7 @@ pkgAcqMetaSig::pkgAcqMetaSig(pkgAcquire * const Owner,
    RemoveFile("pkgAcqMetaSig", DestFile);
 
    // set the TransactionManager
-   if(_config->FindB("Debug::Acquire::Transaction", false) == true)
+   if(DebugTransaction() == true)
       std::clog << "New pkgAcqMetaSig with TransactionManager "
                 << TransactionManager << std::endl;
 
@@ -3130,7 +3141,7 @@ pkgAcqIndex::pkgAcqIndex(pkgAcquire * const Owner,
       return;
    Init(Target.URI, Target.Description, Target.ShortDesc);
 
-   if(_config->FindB("Debug::Acquire::Transaction", false) == true)
+   if(DebugTransaction() == true)
       std::clog << "New pkgIndex with TransactionManager "
                 << TransactionManager << std::endl;
 }
@@ -3329,6 +3340,78 @@ void pkgAcqIndex::StageDecompressDone()
 									/*}}}*/
 pkgAcqIndex::~pkgAcqIndex() {}
 
+// SharedArchives - content-addressed store of archives			/*{{{*/
+/* Archives can be shared between e.g. chroots via a store indexed by their
+   SHA256 hash. Files are only ever added atomically to it, so multiple apt
+   processes can populate and use it at the same time without locking. */
+static std::string GetSharedArchiveFilename(HashStringList const &Hashes)
+{
+   if (_config->Exists("Dir::Cache::SharedArchives") == false)
+      return "";
+   auto const sha256 = Hashes.find("SHA256");
+   if (sha256 == nullptr || sha256->HashValue().length() < 2)
+      return "";
+   std::string const hash = sha256->HashValue();
+   return flCombine(_config->FindDir("Dir::Cache::SharedArchives"),
+		    "SHA256/" + hash.substr(0, 2) + "/" + hash);
+}
+static bool LinkOrCopyFile(std::string const &From, std::string const &To)
+{
+   if (link(From.c_str(), To.c_str()) == 0 || errno == EEXIST)
+      return true;
+
+   // on different filesystems we clone or copy to a temporary file instead
+   std::string const Temp = To + ".tmp-" + std::to_string(getpid());
+   FileFd In(From, FileFd::ReadOnly);
+   FileFd Out(Temp, FileFd::WriteOnly | FileFd::Create | FileFd::Empty, 0644);
+   bool Okay = In.IsOpen() && Out.IsOpen();
+   if (Okay)
+   {
+#ifdef FICLONE
+      Okay = ioctl(Out.Fd(), FICLONE, In.Fd()) == 0 || CopyFile(In, Out);
+#else
+      Okay = CopyFile(In, Out);
+#endif
+   }
+   Okay = Out.Close() && Okay;
+   if (Okay == false || rename(Temp.c_str(), To.c_str()) != 0)
+   {
+      RemoveFile("LinkOrCopyFile", Temp);
+      return false;
+   }
+   return true;
+}
+static bool GetSharedArchive(HashStringList const &ExpectedHashes, unsigned long long const Size,
+			     std::string const &FinalFile)
+{
+   std::string const SharedFile = GetSharedArchiveFilename(ExpectedHashes);
+   struct stat Buf;
+   if (SharedFile.empty() || stat(SharedFile.c_str(), &Buf) != 0 ||
+       static_cast<unsigned long long>(Buf.st_size) != Size)
+      return false;
+
+   _error->PushToStack();
+   bool Okay = false;
+   {
+      FileFd Fd(SharedFile, FileFd::ReadOnly);
+      Hashes Hash(ExpectedHashes);
+      Okay = Fd.IsOpen() && Hash.AddFD(Fd) && Hash.GetHashStringList() == ExpectedHashes;
+   }
+   Okay = Okay && LinkOrCopyFile(SharedFile, FinalFile);
+   _error->RevertToStack();
+   return Okay;
+}
+static void PutSharedArchive(HashStringList const &Hashes, std::string const &FinalFile)
+{
+   std::string const SharedFile = GetSharedArchiveFilename(Hashes);
+   if (SharedFile.empty())
+      return;
+   _error->PushToStack();
+   CreateDirectory(_config->FindDir("Dir::Cache::SharedArchives"), flNotFile(SharedFile));
+   LinkOrCopyFile(FinalFile, SharedFile);
+   _error->RevertToStack();
+}
+									/*}}}*/
 // AcqArchive::AcqArchive - Constructor					/*{{{*/
 // ---------------------------------------------------------------------
 /* This just sets up the initial fetch environment and queues the first
@@ -3495,6 +3578,16 @@ pkgAcqArchive::pkgAcqArchive(pkgAcquire *const Owner, pkgSourceList *const Sourc
       RemoveFile("pkgAcqArchive::QueueNext", FinalFile);
    }
 
+   // Check if another chroot or container has downloaded it already
+   if (GetSharedArchive(ExpectedHashes, Version->Size, FinalFile))
+   {
+      Complete = true;
+      Local = true;
+      Status = StatDone;
+      StoreFilename = DestFile = FinalFile;
+      return;
+   }
+
    // Check the destination file
    DestFile = _config->FindDir("Dir::Cache::Archives") + "partial/" + flNotDir(StoreFilename);
    if (stat(DestFile.c_str(), &Buf) == 0)
@@ -3550,6 +3643,7 @@ void pkgAcqArchive::Done(string const &Message, HashStringList const &Hashes,
    Rename(DestFile,FinalFile);
    StoreFilename = DestFile = FinalFile;
    Complete = true;
+   PutSharedArchive(GetExpectedHashes(), FinalFile);
 }
 									/*}}}*/
 // AcqArchive::Failed - Failure handler					/*{{{*/
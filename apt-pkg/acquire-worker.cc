@@ -351,7 +351,7 @@ bool pkgAcquire::Worker::RunMessages()
 		  desc.URI = NewURI;
 	       }
 	       if (isDoomedItem(Owner) == false)
-		  OwnerQ->Owner->Enqueue(desc);
+		  OwnerQ->Owner->Enqueue(desc, OwnerQ);
 	    }
             break;
          }
@@ -304,7 +304,16 @@ static bool CheckForBadItemAndFailIt(pkgAcquire::Item * const Item,
    }
    return false;
 }
+static unsigned long long ExpectedSize(pkgAcquire::Item const * const Item)
+{
+   auto const Size = Item->GetExpectedHashes().FileSize();
+   return Size != 0 ? Size : Item->FileSize;
+}
 void pkgAcquire::Enqueue(ItemDesc &Item)
+{
+   Enqueue(Item, nullptr);
+}
+void pkgAcquire::Enqueue(ItemDesc &Item, Queue const * const Redirector)
 {
    // Determine which queue to put the item in
    const MethodConfig *Config = nullptr;
@@ -315,6 +324,53 @@ void pkgAcquire::Enqueue(ItemDesc &Item)
       return;
    }
 
+   /* Starting another method for the host we were redirected to would
+      connect to it again while the method which got the redirect can
+      keep its connections to both hosts in its pool */
+   if (Redirector != nullptr && QueueMode == QueueHost && Config->SingleInstance == false &&
+       Name != Redirector->Name && APT::String::Startswith(Redirector->Name, Config->Access + ':') &&
+       _config->FindI("Acquire::" + Config->Access + "::Connection-Pool", 4) > 0)
+   {
+      Queue const *Q = Queues;
+      for (; Q != nullptr && Q->Name != Name; Q = Q->Next);
+      if (Q == nullptr)
+	 Name = Redirector->Name;
+   }
+
+   /* Large files are spread over additional queues (and so connections)
+      per host, so that small files can proceed instead of waiting in the
+      same pipeline until the large ones are done */
+   if (QueueMode == QueueHost && Config->SingleInstance == false)
+   {
+      static Configuration::Key const LargeFileSize("Acquire::QueueHost::Large-File-Size");
+      static Configuration::Key const PerHostLimit("Acquire::QueueHost::Per-Host-Limit");
+      auto const LargeSize = _config->FindI(LargeFileSize, 0);
+      auto const Limit = _config->FindI(PerHostLimit, 2);
+      URI const U(Item.URI);
+      if (LargeSize > 0 && Limit > 1 && ExpectedSize(Item.Owner) >= static_cast<unsigned long long>(LargeSize) &&
+	  Name == U.Access + ':' + U.Host)
+      {
+	 // the least busy of them gets it, so they all finish at about the same time
+	 std::string Selected;
+	 auto SelectedBacklog = std::numeric_limits<unsigned long long>::max();
+	 for (int N = 1; N < Limit && SelectedBacklog != 0; ++N)
+	 {
+	    std::string const LargeName = Name + "#large" + (N == 1 ? "" : std::to_string(N));
+	    unsigned long long Backlog = 0;
+	    for (Queue const *Q = Queues; Q != nullptr; Q = Q->Next)
+	       if (Q->Name == LargeName)
+		  for (auto const *I = Q->Items; I != nullptr; I = I->Next)
+		     Backlog += ExpectedSize(I->Owner);
+	    if (Backlog < SelectedBacklog)
+	    {
+	       Selected = LargeName;
+	       SelectedBacklog = Backlog;
+	    }
+	 }
+	 Name = std::move(Selected);
+      }
+   }
+
    /* the check for running avoids that we produce errors
       in logging before we actually have started, which would
       be easier to implement but would confuse users/implementations
@@ -465,9 +521,10 @@ string pkgAcquire::QueueName(string Uri,MethodConfig const *&Config)
 
       int existing = 0;
       // check how many queues exist already and reuse empty ones
+      // (the additional queues for large files do not count as a host)
       auto const AccessSchema = U.Access + ':';
       for (Queue const *Q = Queues; Q != nullptr; Q = Q->Next)
-	 if (APT::String::Startswith(Q->Name, AccessSchema))
+	 if (APT::String::Startswith(Q->Name, AccessSchema) && Q->Name.find("#large") == std::string::npos)
 	    ++existing;
 
       int const Limit = _config->FindI("Acquire::QueueHost::Limit", DEFAULT_HOST_LIMIT);
@@ -941,13 +998,18 @@ bool pkgAcquire::Queue::Enqueue(ItemDesc &Item)
       }
       return true;
    };
+   // queues for large files start with the largest, so that the longest
+   // downloads are not the last ones still running at the end
+   bool const LargestFirst = Name.find("#large") != std::string::npos;
+   auto const Size = LargestFirst ? ExpectedSize(Item.Owner) : 0;
    QItem **OptimalI = &Items;
    QItem **I = &Items;
    // move to the end of the queue and check for duplicates here
    for (; *I != 0; ) {
       if (Item.URI == (*I)->URI && MetaKeysMatch(Item, *I))
       {
-	 if (_config->FindB("Debug::pkgAcquire::Worker",false) == true)
+	 static Configuration::Key const DebugWorker("Debug::pkgAcquire::Worker");
+	 if (_config->FindB(DebugWorker,false) == true)
 	    std::cerr << " @ Queue: Action combined for " << Item.URI << " and " << (*I)->URI << std::endl;
 	 (*I)->Owners.push_back(Item.Owner);
 	 Item.Owner->Status = (*I)->Owner->Status;
@@ -956,9 +1018,12 @@ bool pkgAcquire::Queue::Enqueue(ItemDesc &Item)
       // Determine the optimal position to insert: before anything with a
       // higher priority.
       int priority = (*I)->GetPriority();
+      bool const Before = priority > Item.Owner->Priority() ||
+	 (priority == Item.Owner->Priority() && (LargestFirst == false || ExpectedSize((*I)->Owner) >= Size ||
+						 (*I)->Owner->Status != pkgAcquire::Item::StatIdle));
 
       I = &(*I)->Next;
-      if (priority >= Item.Owner->Priority()) {
+      if (Before) {
 	 OptimalI = I;
       }
    }
@@ -1351,8 +1416,12 @@ bool pkgAcquireStatus::Pulse(pkgAcquire *Owner)
       Percent = (0.8 * (CurrentBytes/double(TotalBytes)*100.0) +
                  0.2 * (CurrentItems/double(TotalItems)*100.0));
 
+   static Configuration::Key const DebugProgress("Debug::acquire::progress");
+   static Configuration::Key const ProgressDiffPercent("Acquire::Progress::Diffpercent");
+   static Configuration::Key const StatusFd("APT::Status-Fd");
+
    // debug
-   if (_config->FindB("Debug::acquire::progress", false) == true)
+   if (_config->FindB(DebugProgress, false) == true)
    {
       std::clog
          << "["
@@ -1366,10 +1435,10 @@ bool pkgAcquireStatus::Pulse(pkgAcquire *Owner)
    }
 
    double const DiffPercent = Percent - OldPercent;
-   if (DiffPercent < 0.001 && _config->FindB("Acquire::Progress::Diffpercent", false) == true)
+   if (DiffPercent < 0.001 && _config->FindB(ProgressDiffPercent, false) == true)
       return true;
 
-   int fd = _config->FindI("APT::Status-Fd",-1);
+   int fd = _config->FindI(StatusFd,-1);
    if(fd > 0)
    {
       unsigned long long ETA = 0;
@@ -189,6 +189,12 @@ class APT_PUBLIC pkgAcquire
     *  retained.
     */
    void Enqueue(ItemDesc &Item);
+   /** \brief Insert a fetch request the method of \a Redirector was redirected for.
+    *
+    *  A redirect to a host without a queue of its own is followed by the
+    *  method which got it if it keeps idle connections for reuse.
+    */
+   APT_HIDDEN void Enqueue(ItemDesc &Item, Queue const * const Redirector);
 
    /** \brief Remove all fetch requests for this item from all queues. */
    void Dequeue(Item *Item);
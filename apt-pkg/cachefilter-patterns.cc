@@ -402,7 +402,7 @@ std::unique_ptr<APT::CacheFilter::Matcher> PatternParser::aPattern(std::unique_p
       nodeP->error("Expected a pattern");
 
    if (node->matches("?architecture", 1, 1))
-      return std::make_unique<APT::CacheFilter::PackageArchitectureMatchesSpecification>(aWord(node->arguments[0]));
+      return std::make_unique<Patterns::PackageIsArchitecture>(aWord(node->arguments[0]));
    if (node->matches("?archive", 1, 1))
       return std::make_unique<Patterns::VersionIsArchive>(aWord(node->arguments[0]));
    if (node->matches("?all-versions", 1, 1))
@@ -439,6 +439,10 @@ std::unique_ptr<APT::CacheFilter::Matcher> PatternParser::aPattern(std::unique_p
       return std::make_unique<Patterns::VersionIsSourcePackage>(aWord(node->arguments[0]));
    if (node->matches("?source-version", 1, 1))
       return std::make_unique<Patterns::VersionIsSourceVersion>(aWord(node->arguments[0]));
+   if (node->matches("?tag", 1, 1))
+      return std::make_unique<Patterns::VersionHasFieldValue>("Tag", aWord(node->arguments[0]));
+   if (node->matches("?task", 1, 1))
+      return std::make_unique<Patterns::VersionHasFieldValue>("Task", aWord(node->arguments[0]));
    if (node->matches("?true", 0, 0))
       return std::make_unique<APT::CacheFilter::TrueMatcher>();
    if (node->matches("?upgradable", 0, 0))
@@ -486,6 +490,30 @@ std::string PatternParser::aWord(std::unique_ptr<PatternTreeParser::Node> &nodeP
 namespace Patterns
 {
 
+bool VersionHasFieldValue::operator()(pkgCache::VerIterator const &Ver)
+{
+   if (versions.empty())
+   {
+      auto const Cache = Ver.Cache();
+      versions.resize(Cache->Head().VersionCount, false);
+      auto const Values = Cache->FindFieldValues(field);
+      map_stringitem_t LastValue = 0;
+      bool LastMatch = false;
+      for (auto V = Values.first; V != Values.second; ++V)
+      {
+	 // entries are sorted by value, so each value is matched only once
+	 if (V->Value != LastValue)
+	 {
+	    LastValue = V->Value;
+	    LastMatch = matcher(Cache->StrP + LastValue);
+	 }
+	 if (LastMatch)
+	    versions[(Cache->VerP + V->Version)->ID] = true;
+      }
+   }
+   return versions[Ver->ID];
+}
+
 BaseRegexMatcher::BaseRegexMatcher(std::string const &Pattern)
 {
    pattern = new regex_t;
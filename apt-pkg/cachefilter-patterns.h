@@ -17,6 +17,8 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <assert.h>
 
@@ -146,6 +148,46 @@ class BaseRegexMatcher
    }
 };
 
+/**
+ * \brief Remember the results of a string matcher per cache string
+ *
+ * The generator stores architectures, sections, archives, origins, … only
+ * once in the cache, so the offset of such a string identifies it and the
+ * wrapped matcher has to run only once for each distinct value.
+ */
+template <class Matcher>
+class APT_HIDDEN StringIDMatcher
+{
+   Matcher matcher;
+   std::unordered_map<uint32_t, bool> results;
+
+   public:
+   template <typename... Args>
+   explicit StringIDMatcher(Args &&...args) : matcher(std::forward<Args>(args)...) {}
+   bool operator()(pkgCache const *Cache, map_stringitem_t String)
+   {
+      if (String == nullptr)
+	 return false;
+      auto const Found = results.find(uint32_t(String));
+      if (Found != results.end())
+	 return Found->second;
+      char const *const Value = Cache->StrP + String;
+      bool const Match = matcher(Value);
+      results.emplace(uint32_t(String), Match);
+      return Match;
+   }
+};
+
+struct APT_HIDDEN PackageIsArchitecture : public PackageMatcher
+{
+   StringIDMatcher<APT::CacheFilter::PackageArchitectureMatchesSpecification> matcher;
+   explicit PackageIsArchitecture(std::string const &pattern) : matcher(pattern) {}
+   bool operator()(pkgCache::PkgIterator const &Pkg) override
+   {
+      return matcher(Pkg.Cache(), Pkg->Arch);
+   }
+};
+
 struct APT_HIDDEN PackageIsAutomatic : public PackageMatcher
 {
    pkgCacheFile *Cache;
@@ -306,13 +348,16 @@ struct APT_HIDDEN VersionIsAnyVersion : public VersionAnyMatcher
 
 struct APT_HIDDEN VersionIsArchive : public VersionAnyMatcher
 {
-   BaseRegexMatcher matcher;
+   StringIDMatcher<BaseRegexMatcher> matcher;
    VersionIsArchive(std::string const &pattern) : matcher(pattern) {}
    bool operator()(pkgCache::VerIterator const &Ver) override
    {
       for (auto VF = Ver.FileList(); not VF.end(); VF++)
       {
-	 if (VF.File().Archive() && matcher(VF.File().Archive()))
+	 auto const File = VF.File();
+	 // status files have no release file and report their component instead
+	 auto const Archive = File->Release == 0 ? File->Component : File.ReleaseFile()->Archive;
+	 if (matcher(Ver.Cache(), Archive))
 	    return true;
       }
       return false;
@@ -321,13 +366,14 @@ struct APT_HIDDEN VersionIsArchive : public VersionAnyMatcher
 
 struct APT_HIDDEN VersionIsOrigin : public VersionAnyMatcher
 {
-   BaseRegexMatcher matcher;
+   StringIDMatcher<BaseRegexMatcher> matcher;
    VersionIsOrigin(std::string const &pattern) : matcher(pattern) {}
    bool operator()(pkgCache::VerIterator const &Ver) override
    {
       for (auto VF = Ver.FileList(); not VF.end(); VF++)
       {
-	 if (VF.File().Origin() && matcher(VF.File().Origin()))
+	 auto const File = VF.File();
+	 if (File->Release != 0 && matcher(Ver.Cache(), File.ReleaseFile()->Origin))
 	    return true;
       }
       return false;
@@ -336,14 +382,29 @@ struct APT_HIDDEN VersionIsOrigin : public VersionAnyMatcher
 
 struct APT_HIDDEN VersionIsSection : public VersionAnyMatcher
 {
-   BaseRegexMatcher matcher;
+   StringIDMatcher<BaseRegexMatcher> matcher;
    VersionIsSection(std::string const &pattern) : matcher(pattern) {}
    bool operator()(pkgCache::VerIterator const &Ver) override
    {
-      return matcher(Ver.Section());
+      return matcher(Ver.Cache(), Ver->Section);
    }
 };
 
+/**
+ * \brief Match versions by a value of an indexed field like Task
+ *
+ * The values are looked up in the index of the cache on first use, so
+ * no record has to be parsed for matching.
+ */
+struct APT_HIDDEN VersionHasFieldValue : public VersionAnyMatcher
+{
+   std::string field;
+   BaseRegexMatcher matcher;
+   std::vector<bool> versions;
+   VersionHasFieldValue(std::string const &field, std::string const &pattern) : field(field), matcher(pattern) {}
+   bool operator()(pkgCache::VerIterator const &Ver) override;
+};
+
 struct APT_HIDDEN VersionIsSourcePackage : public VersionAnyMatcher
 {
    BaseRegexMatcher matcher;
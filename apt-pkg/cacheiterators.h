@@ -169,6 +169,8 @@ class APT_PUBLIC pkgCache::PkgIterator: public Iterator<Package, PkgIterator> {
 	inline VerIterator CurrentVer() const APT_PURE;
 	inline DepIterator RevDependsList() const APT_PURE;
 	inline PrvIterator ProvidesList() const APT_PURE;
+	inline ReverseList<Dependency, DepIterator> RevDependsRange() const APT_PURE;
+	inline ReverseList<Provides, PrvIterator> ProvidesRange() const APT_PURE;
 	OkState State() const APT_PURE;
 	const char *CurVersion() const APT_PURE;
 
@@ -198,7 +200,7 @@ class APT_PUBLIC pkgCache::VerIterator : public Iterator<Version, VerIterator> {
 	inline VerIterator NextInSource()
 	{
 	   if (S != Owner->VerP)
-	      S = Owner->VerP + S->NextInSource;
+	      S = Owner->VerP + Extra()->NextInSource;
 	   return *this;
 	}
 
@@ -209,18 +211,20 @@ class APT_PUBLIC pkgCache::VerIterator : public Iterator<Version, VerIterator> {
 	    This method should be used to identify if two pseudo versions are
 	    referring to the same "real" version */
 	inline bool SimilarVer(const VerIterator &B) const {
-		return (B.end() == false && S->Hash == B->Hash && strcmp(VerStr(), B.VerStr()) == 0);
+		return (B.end() == false && Extra()->Hash == B.Extra()->Hash && strcmp(VerStr(), B.VerStr()) == 0);
 	}
 
 	// Accessors
+	/** \brief the less often used data of this version */
+	inline VersionExtra *Extra() const {return S == Owner->VerP ? Owner->VerExtraP : Owner->VerExtraP + S->Extra;}
 	inline const char *VerStr() const {return S->VerStr == 0?0:Owner->StrP + S->VerStr;}
-	inline const char *Section() const {return S->Section == 0?0:Owner->StrP + S->Section;}
+	inline const char *Section() const {return Extra()->Section == 0?0:Owner->StrP + Extra()->Section;}
 	/** \brief source package name this version comes from
 	   Always contains the name, even if it is the same as the binary name */
-	inline const char *SourcePkgName() const {return Owner->StrP + S->SourcePkgName;}
+	inline const char *SourcePkgName() const {return Owner->StrP + Extra()->SourcePkgName;}
 	/** \brief source version this version comes from
 	   Always contains the version string, even if it is the same as the binary version */
-	inline const char *SourceVerStr() const {return Owner->StrP + S->SourceVerStr;}
+	inline const char *SourceVerStr() const {return Owner->StrP + Extra()->SourceVerStr;}
 	inline const char *Arch() const {
 		if ((S->MultiArch & pkgCache::Version::All) == pkgCache::Version::All)
 			return "all";
@@ -242,6 +246,36 @@ class APT_PUBLIC pkgCache::VerIterator : public Iterator<Version, VerIterator> {
 	bool Automatic() const;
 	VerFileIterator NewestFile() const;
 
+	// overrides because we are special
+	struct VersionProxy
+	{
+	   map_stringitem_t &VerStr;
+	   map_stringitem_t &Section;
+	   map_stringitem_t &SourcePkgName;
+	   map_stringitem_t &SourceVerStr;
+	   map_number_t &MultiArch;
+	   map_pointer<pkgCache::VerFile> &FileList;
+	   map_pointer<pkgCache::Version> &NextVer;
+	   map_pointer<pkgCache::Description> &DescriptionList;
+	   map_pointer<pkgCache::Dependency> &DependsList;
+	   map_pointer<pkgCache::Package> &ParentPkg;
+	   map_pointer<pkgCache::Provides> &ProvidesList;
+	   map_filesize_t &Size;
+	   map_filesize_t &InstalledSize;
+	   uint32_t &Hash;
+	   map_id_t &ID;
+	   map_number_t &Priority;
+	   map_pointer<pkgCache::Version> &NextInSource;
+	   map_pointer<pkgCache::VersionExtra> &Extra;
+	   VersionProxy const * operator->() const { return this; }
+	   VersionProxy * operator->() { return this; }
+	};
+	inline VersionProxy operator->() const {
+		VersionExtra * const X = Extra();
+		return (VersionProxy) { S->VerStr, X->Section, X->SourcePkgName, X->SourceVerStr, S->MultiArch, S->FileList, S->NextVer, X->DescriptionList, S->DependsList, S->ParentPkg, S->ProvidesList, X->Size, X->InstalledSize, X->Hash, S->ID, S->Priority, X->NextInSource, S->Extra };
+	}
+	inline VersionProxy operator->() { return static_cast<VerIterator const *>(this)->operator->(); }
+
 	inline VerIterator(pkgCache &Owner,Version *Trg = 0) : Iterator<Version, VerIterator>(Owner, Trg) {
 		if (S == 0)
 			S = OwnerPointer();
@@ -401,6 +435,63 @@ class APT_PUBLIC pkgCache::PrvIterator : public Iterator<Provides, PrvIterator>
 	}
 };
 									/*}}}*/
+// Reverse list								/*{{{*/
+/* The reverse dependencies and provides of a package are linked lists
+   through the structures of the depending and providing versions. If the
+   cache has a reverse index they are read from its contiguous arrays
+   instead, which yields them in the same order without jumping around in
+   the map. The elements are the usual iterators, but they must not be
+   advanced themselves as they are not positioned in the linked list. */
+template<typename Str, typename Itr> class APT_PUBLIC pkgCache::ReverseList {
+	Itr List;
+	map_pointer<Str> const *First;
+	map_pointer<Str> const *Last;
+
+	public:
+	class const_iterator : public std::iterator<std::forward_iterator_tag, Itr const> {
+		Itr Pos;
+		map_pointer<Str> const *Cur;
+		map_pointer<Str> const *Last;
+
+		inline void Load() {
+			if (Cur != Last)
+				Pos = Itr(*Pos.Cache(), Pos.OwnerPointer() + *Cur, static_cast<Package *>(nullptr));
+		}
+
+		public:
+		inline const_iterator& operator++() {
+			if (Cur == nullptr)
+				++Pos;
+			else
+			{
+				++Cur;
+				Load();
+			}
+			return *this;
+		}
+		inline const_iterator operator++(int) { const_iterator const tmp(*this); operator++(); return tmp; }
+		inline bool operator==(const_iterator const &B) const {
+			if (Cur != nullptr || B.Cur != nullptr)
+				return Cur == B.Cur;
+			return Pos == B.Pos;
+		}
+		inline bool operator!=(const_iterator const &B) const { return operator==(B) == false; }
+		inline Itr const &operator*() const { return Pos; }
+		inline Itr const *operator->() const { return &Pos; }
+
+		inline const_iterator(Itr const &Pos, map_pointer<Str> const *Cur, map_pointer<Str> const *Last) :
+			Pos(Pos), Cur(Cur), Last(Last) { Load(); }
+	};
+
+	inline const_iterator begin() const { return const_iterator(List, First, Last); }
+	inline const_iterator end() const {
+		return const_iterator(Itr(*List.Cache(), nullptr, static_cast<Package *>(nullptr)), Last, Last);
+	}
+
+	inline ReverseList(Itr const &List, std::pair<map_pointer<Str> const *, map_pointer<Str> const *> const &Index) :
+		List(List), First(Index.first), Last(Index.second) {}
+};
+									/*}}}*/
 // Release file								/*{{{*/
 class APT_PUBLIC pkgCache::RlsFileIterator : public Iterator<ReleaseFile, RlsFileIterator> {
 	public:
@@ -515,8 +606,12 @@ inline pkgCache::DepIterator pkgCache::PkgIterator::RevDependsList() const
        {return DepIterator(*Owner,Owner->DepP + S->RevDepends,S);}
 inline pkgCache::PrvIterator pkgCache::PkgIterator::ProvidesList() const
        {return PrvIterator(*Owner,Owner->ProvideP + S->ProvidesList,S);}
+inline pkgCache::ReverseList<pkgCache::Dependency, pkgCache::DepIterator> pkgCache::PkgIterator::RevDependsRange() const
+       {return {RevDependsList(), Owner->RevDependsIndex(S)};}
+inline pkgCache::ReverseList<pkgCache::Provides, pkgCache::PrvIterator> pkgCache::PkgIterator::ProvidesRange() const
+       {return {ProvidesList(), Owner->ProvidesIndex(S)};}
 inline pkgCache::DescIterator pkgCache::VerIterator::DescriptionList() const
-       {return DescIterator(*Owner,Owner->DescP + S->DescriptionList);}
+       {return DescIterator(*Owner,Owner->DescP + Extra()->DescriptionList);}
 inline pkgCache::PrvIterator pkgCache::VerIterator::ProvidesList() const
        {return PrvIterator(*Owner,Owner->ProvideP + S->ProvidesList,S);}
 inline pkgCache::DepIterator pkgCache::VerIterator::DependsList() const
@@ -21,7 +21,6 @@
 #include <apt-pkg/fileutl.h>
 #include <apt-pkg/macros.h>
 #include <apt-pkg/pkgcache.h>
-#include <apt-pkg/pkgrecords.h>
 #include <apt-pkg/policy.h>
 #include <apt-pkg/versionmatch.h>
 
@@ -71,38 +70,35 @@ bool CacheSetHelper::PackageFromTask(PackageContainerInterface * const pci, pkgC
 	if (wasEmpty == true)
 		pci->setConstructor(CacheSetHelper::TASK);
 
-	// get the records
-	pkgRecords Recs(Cache);
-
 	// build regexp for the task
 	regex_t Pattern;
-	char S[300];
-	snprintf(S, sizeof(S), "^Task:.*[, ]%s([, ]|$)", pattern.c_str());
-	if(regcomp(&Pattern,S, REG_EXTENDED | REG_NOSUB | REG_NEWLINE) != 0) {
+	std::string const S = "^(" + pattern + ")$";
+	if(regcomp(&Pattern,S.c_str(), REG_EXTENDED | REG_NOSUB) != 0) {
 		_error->Error("Failed to compile task regexp");
 		return false;
 	}
 
+	// the generator indexed the values of the Task field of all versions
 	bool found = false;
-	for (pkgCache::GrpIterator Grp = Cache->GrpBegin(); Grp.end() == false; ++Grp) {
-		pkgCache::PkgIterator Pkg = Grp.FindPkg(arch);
-		if (Pkg.end() == true)
+	auto const Tasks = Cache.GetPkgCache()->FindFieldValues("Task");
+	map_stringitem_t LastValue = 0;
+	bool LastMatch = false;
+	std::vector<bool> Seen(Cache.GetPkgCache()->Head().PackageCount, false);
+	for (auto T = Tasks.first; T != Tasks.second; ++T) {
+		if (T->Value != LastValue) {
+			LastValue = T->Value;
+			LastMatch = regexec(&Pattern, Cache.GetPkgCache()->StrP + LastValue, 0, 0, 0) == 0;
+		}
+		if (LastMatch == false)
 			continue;
-		pkgCache::VerIterator ver = Cache[Pkg].CandidateVerIter(Cache);
-		if(ver.end() == true)
+		pkgCache::VerIterator const TaskVer(*Cache.GetPkgCache(), Cache.GetPkgCache()->VerP + T->Version);
+		pkgCache::PkgIterator Pkg = TaskVer.ParentPkg().Group().FindPkg(arch);
+		if (Pkg.end() == true || Pkg != TaskVer.ParentPkg())
 			continue;
-
-		pkgRecords::Parser &parser = Recs.Lookup(ver.FileList());
-		const char *start, *end;
-		parser.GetRec(start,end);
-		unsigned int const length = end - start;
-		if (unlikely(length == 0))
-		   continue;
-		char buf[length];
-		strncpy(buf, start, length);
-		buf[length-1] = '\0';
-		if (regexec(&Pattern, buf, 0, 0, 0) != 0)
+		pkgCache::VerIterator ver = Cache[Pkg].CandidateVerIter(Cache);
+		if(ver != TaskVer || Seen[Pkg->ID] == true)
 			continue;
+		Seen[Pkg->ID] = true;
 
 		pci->insert(Pkg);
 		showPackageSelection(Pkg, CacheSetHelper::TASK, pattern);
@@ -122,6 +118,27 @@ bool CacheSetHelper::PackageFromTask(PackageContainerInterface * const pci, pkgC
 	return true;
 }
 									/*}}}*/
+// RegExPrefix/FnmatchPrefix - literal start shared by all matches	/*{{{*/
+/* Both are matched ignoring case, which FindGrpPrefix does as well, so we can
+   restrict the search to the groups starting with the literal prefix. */
+static std::string RegExPrefix(std::string const &pattern)
+{
+	// only anchored expressions without alternatives have a fixed start
+	if (pattern.empty() == true || pattern[0] != '^' || pattern.find('|') != std::string::npos)
+		return "";
+	size_t end = pattern.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-", 1);
+	if (end == std::string::npos)
+		return pattern.substr(1);
+	// a quantifier applies to the character before it
+	if (strchr("?*+{", pattern[end]) != nullptr && end > 1)
+		--end;
+	return pattern.substr(1, end - 1);
+}
+static std::string FnmatchPrefix(std::string const &pattern)
+{
+	return pattern.substr(0, pattern.find_first_of("*?[\\"));
+}
+									/*}}}*/
 // PackageFromRegEx - Return all packages in the cache matching a pattern /*{{{*/
 bool CacheSetHelper::PackageFromRegEx(PackageContainerInterface * const pci, pkgCacheFile &Cache, std::string pattern) {
 	static const char * const isregex = ".?+*|[^$";
@@ -156,7 +173,9 @@ bool CacheSetHelper::PackageFromRegEx(PackageContainerInterface * const pci, pkg
 	APT::CacheFilter::PackageNameMatchesRegEx regexfilter(pattern);
 
 	bool found = false;
-	for (pkgCache::GrpIterator Grp = Cache.GetPkgCache()->GrpBegin(); Grp.end() == false; ++Grp) {
+	auto const Groups = Cache.GetPkgCache()->FindGrpPrefix(RegExPrefix(pattern));
+	for (auto G = Groups.first; G != Groups.second; ++G) {
+		pkgCache::GrpIterator Grp(*Cache.GetPkgCache(), Cache.GetPkgCache()->GrpP + *G);
 		if (regexfilter(Grp) == false)
 			continue;
 		pkgCache::PkgIterator Pkg = Grp.FindPkg(arch);
@@ -217,7 +236,9 @@ bool CacheSetHelper::PackageFromFnmatch(PackageContainerInterface * const pci,
 	APT::CacheFilter::PackageNameMatchesFnmatch filter(pattern);
 
 	bool found = false;
-	for (pkgCache::GrpIterator Grp = Cache.GetPkgCache()->GrpBegin(); Grp.end() == false; ++Grp) {
+	auto const Groups = Cache.GetPkgCache()->FindGrpPrefix(FnmatchPrefix(pattern));
+	for (auto G = Groups.first; G != Groups.second; ++G) {
+		pkgCache::GrpIterator Grp(*Cache.GetPkgCache(), Cache.GetPkgCache()->GrpP + *G);
 		if (filter(Grp) == false)
 			continue;
 		pkgCache::PkgIterator Pkg = Grp.FindPkg(arch);
@@ -20,6 +20,7 @@
 #include <apt-pkg/error.h>
 #include <apt-pkg/fileutl.h>
 #include <apt-pkg/macros.h>
+#include <apt-pkg/string_view.h>
 #include <apt-pkg/strutl.h>
 
 #include <ctype.h>
@@ -194,13 +195,95 @@ static bool LoadConfigurationIndex(std::string const &filename)		/*{{{*/
    return true;
 }
 									/*}}}*/
+// IndexedItem - Item with an index of its children			/*{{{*/
+// ---------------------------------------------------------------------
+/* All items are allocated as IndexedItem: besides the list of children
+   each item keeps a hash index of the (unique) tags of its children and
+   the end of that list, so neither finding a child nor appending a new
+   one needs to walk the siblings. The index refers to the Tag of the
+   children which is never changed after the child was created. */
+static size_t TagHash(char const *S, size_t const Len)
+{
+   size_t Hash = 5381;
+   for (char const * const End = S + Len; S != End; ++S)
+      Hash = 33 * Hash + tolower_ascii_unsafe(*S);
+   return Hash;
+}
+namespace {
+struct TagKey
+{
+   APT::StringView Tag;
+   size_t Hash;
+};
+struct TagKeyHash
+{
+   size_t operator()(TagKey const &K) const noexcept { return K.Hash; }
+};
+struct TagKeyEqual
+{
+   bool operator()(TagKey const &A, TagKey const &B) const
+   {
+      return A.Tag.length() == B.Tag.length() &&
+	 stringcasecmp(A.Tag.begin(), A.Tag.end(), B.Tag.begin(), B.Tag.end()) == 0;
+   }
+};
+struct IndexedItem : public Configuration::Item
+{
+   std::unordered_map<TagKey, Configuration::Item *, TagKeyHash, TagKeyEqual> Children;
+   Configuration::Item *LastChild = nullptr;
+
+   void AddChild(Configuration::Item * const I)
+   {
+      if (LastChild == nullptr)
+	 Child = I;
+      else
+	 LastChild->Next = I;
+      LastChild = I;
+      if (I->Tag.empty() == false)
+	 Children.emplace(TagKey{I->Tag, TagHash(I->Tag.c_str(), I->Tag.length())}, I);
+   }
+   void ReindexChildren()
+   {
+      Children.clear();
+      LastChild = nullptr;
+      for (Configuration::Item *I = Child; I != nullptr; I = I->Next)
+      {
+	 LastChild = I;
+	 if (I->Tag.empty() == false)
+	    Children.emplace(TagKey{I->Tag, TagHash(I->Tag.c_str(), I->Tag.length())}, I);
+      }
+   }
+};
+}
+static IndexedItem *Indexed(Configuration::Item * const I)
+{
+   return static_cast<IndexedItem *>(I);
+}
+static IndexedItem const *Indexed(Configuration::Item const * const I)
+{
+   return static_cast<IndexedItem const *>(I);
+}
+static void DeleteItem(Configuration::Item const * const I)
+{
+   delete Indexed(I);
+}
+									/*}}}*/
+// Configuration::Key::Key - Precompile an option name			/*{{{*/
+Configuration::Key::Key(char const * const Option) : Name(Option)
+{
+   size_t Start = 0;
+   for (size_t End; (End = Name.find("::", Start)) != std::string::npos; Start = End + 2)
+      Scopes.emplace_back(Name.substr(Start, End - Start), TagHash(Name.c_str() + Start, End - Start));
+   Scopes.emplace_back(Name.substr(Start), TagHash(Name.c_str() + Start, Name.length() - Start));
+}
+									/*}}}*/
 
 // Configuration::Configuration - Constructor				/*{{{*/
 // ---------------------------------------------------------------------
 /* */
 Configuration::Configuration() : ToFree(true)
 {
-   Root = new Item;
+   Root = new IndexedItem;
 }
 Configuration::Configuration(const Item *Root) : Root((Item *)Root), ToFree(false)
 {
@@ -226,13 +309,13 @@ Configuration::~Configuration()
       while (Top != 0 && Top->Next == 0)
       {
 	 Item *Parent = Top->Parent;
-	 delete Top;
+	 DeleteItem(Top);
 	 Top = Parent;
       }      
       if (Top != 0)
       {
 	 Item *Next = Top->Next;
-	 delete Top;
+	 DeleteItem(Top);
 	 Top = Next;
       }
    }
@@ -245,33 +328,43 @@ Configuration::~Configuration()
 Configuration::Item *Configuration::Lookup(Item *Head,const char *S,
 					   unsigned long const &Len,bool const &Create)
 {
-   int Res = 1;
-   Item *I = Head->Child;
-   Item **Last = &Head->Child;
-   
+   IndexedItem * const Parent = Indexed(Head);
+
    // Empty strings match nothing. They are used for lists.
    if (Len != 0)
    {
-      for (; I != 0; Last = &I->Next, I = I->Next)
-	 if (Len == I->Tag.length() && (Res = stringcasecmp(I->Tag,S,S + Len)) == 0)
-	    break;
+      auto const I = Parent->Children.find(TagKey{APT::StringView(S, Len), TagHash(S, Len)});
+      if (I != Parent->Children.end())
+	 return I->second;
    }
-   else
-      for (; I != 0; Last = &I->Next, I = I->Next);
-      
-   if (Res == 0)
-      return I;
+
    if (Create == false)
       return 0;
    
-   I = new Item;
+   Item * const I = new IndexedItem;
    I->Tag.assign(S,Len);
-   I->Next = *Last;
    I->Parent = Head;
-   *Last = I;
+   Parent->AddChild(I);
    return I;
 }
 									/*}}}*/
+// Configuration::Lookup - Lookup a precompiled name			/*{{{*/
+const Configuration::Item *Configuration::Lookup(Key const &K) const
+{
+   IndexedItem const *Itm = Indexed(Root);
+   for (auto const &Scope : K.Scopes)
+   {
+      // Empty scopes match nothing like in the lookup by name
+      if (Scope.first.empty() == true)
+	 return 0;
+      auto const I = Itm->Children.find(TagKey{Scope.first, Scope.second});
+      if (I == Itm->Children.end())
+	 return 0;
+      Itm = Indexed(I->second);
+   }
+   return Itm;
+}
+									/*}}}*/
 // Configuration::Lookup - Lookup a fully scoped item			/*{{{*/
 // ---------------------------------------------------------------------
 /* This performs a fully scoped lookup of a given name, possibly creating
@@ -310,10 +403,8 @@ Configuration::Item *Configuration::Lookup(const char *Name,bool const &Create)
 // Configuration::Find - Find a value					/*{{{*/
 // ---------------------------------------------------------------------
 /* */
-string Configuration::Find(const char *Name,const char *Default) const
+static string ItemString(const Configuration::Item *Itm,const char *Default)
 {
-   checkFindConfigOptionType(Name, ConfigType::STRING);
-   const Item *Itm = Lookup(Name);
    if (Itm == 0 || Itm->Value.empty() == true)
    {
       if (Default == 0)
@@ -323,6 +414,16 @@ string Configuration::Find(const char *Name,const char *Default) const
    }
    
    return Itm->Value;
+}
+string Configuration::Find(const char *Name,const char *Default) const
+{
+   checkFindConfigOptionType(Name, ConfigType::STRING);
+   return ItemString(Lookup(Name), Default);
+}
+string Configuration::Find(Key const &K,const char *Default) const
+{
+   checkFindConfigOptionType(K.Name.c_str(), ConfigType::STRING);
+   return ItemString(Lookup(K), Default);
 }
 									/*}}}*/
 // Configuration::FindFile - Find a Filename				/*{{{*/
@@ -428,10 +529,8 @@ vector<string> Configuration::FindVector(const char *Name, std::string const &De
 // Configuration::FindI - Find an integer value				/*{{{*/
 // ---------------------------------------------------------------------
 /* */
-int Configuration::FindI(const char *Name,int const &Default) const
+static int ItemInt(const Configuration::Item *Itm,int const Default)
 {
-   checkFindConfigOptionType(Name, ConfigType::INT);
-   const Item *Itm = Lookup(Name);
    if (Itm == 0 || Itm->Value.empty() == true)
       return Default;
    
@@ -441,19 +540,37 @@ int Configuration::FindI(const char *Name,int const &Default) const
       return Default;
    
    return Res;
+}
+int Configuration::FindI(const char *Name,int const &Default) const
+{
+   checkFindConfigOptionType(Name, ConfigType::INT);
+   return ItemInt(Lookup(Name), Default);
+}
+int Configuration::FindI(Key const &K,int const &Default) const
+{
+   checkFindConfigOptionType(K.Name.c_str(), ConfigType::INT);
+   return ItemInt(Lookup(K), Default);
 }
 									/*}}}*/
 // Configuration::FindB - Find a boolean type				/*{{{*/
 // ---------------------------------------------------------------------
 /* */
-bool Configuration::FindB(const char *Name,bool const &Default) const
+static bool ItemBool(const Configuration::Item *Itm,bool const Default)
 {
-   checkFindConfigOptionType(Name, ConfigType::BOOL);
-   const Item *Itm = Lookup(Name);
    if (Itm == 0 || Itm->Value.empty() == true)
       return Default;
    
    return StringToBool(Itm->Value,Default);
+}
+bool Configuration::FindB(const char *Name,bool const &Default) const
+{
+   checkFindConfigOptionType(Name, ConfigType::BOOL);
+   return ItemBool(Lookup(Name), Default);
+}
+bool Configuration::FindB(Key const &K,bool const &Default) const
+{
+   checkFindConfigOptionType(K.Name.c_str(), ConfigType::BOOL);
+   return ItemBool(Lookup(K), Default);
 }
 									/*}}}*/
 // Configuration::FindAny - Find an arbitrary type			/*{{{*/
@@ -578,13 +695,13 @@ void Configuration::Clear(string const &Name, string const &Value)
 	    Top->Child = I->Next;
 	 I = I->Next;
 	 Prev->Next = I;
-	 delete Tmp;
+	 DeleteItem(Tmp);
       } else {
 	 Prev = I;
 	 I = I->Next;
       }
    }
-     
+   Indexed(Top)->ReindexChildren();
 }
 									/*}}}*/
 // Configuration::Clear - Clear everything				/*{{{*/
@@ -612,6 +729,7 @@ void Configuration::Clear(string const &Name)
    Item *Stop = Top;
    Top = Top->Child;
    Stop->Child = 0;
+   Indexed(Stop)->ReindexChildren();
    for (; Top != 0;)
    {
       if (Top->Child != 0)
@@ -624,7 +742,7 @@ void Configuration::Clear(string const &Name)
       {
 	 Item *Tmp = Top;
 	 Top = Top->Parent;
-	 delete Tmp;
+	 DeleteItem(Tmp);
 	 
 	 if (Top == Stop)
 	    return;
@@ -633,7 +751,7 @@ void Configuration::Clear(string const &Name)
       Item *Tmp = Top;
       if (Top != 0)
 	 Top = Top->Next;
-      delete Tmp;
+      DeleteItem(Tmp);
    }
 }
 									/*}}}*/
@@ -663,6 +781,7 @@ void Configuration::MoveSubTree(char const * const OldRootName, char const * con
    Item * const Stop = Top;
    Top = Top->Child;
    Stop->Child = 0;
+   Indexed(Stop)->ReindexChildren();
    for (; Top != 0;)
    {
       if (Top->Child != 0)
@@ -676,7 +795,7 @@ void Configuration::MoveSubTree(char const * const OldRootName, char const * con
 	 Set(NewRoot + Top->FullTag(OldRoot), Top->Value);
 	 Item const * const Tmp = Top;
 	 Top = Top->Parent;
-	 delete Tmp;
+	 DeleteItem(Tmp);
 
 	 if (Top == Stop)
 	    return;
@@ -686,7 +805,7 @@ void Configuration::MoveSubTree(char const * const OldRootName, char const * con
       Item const * const Tmp = Top;
       if (Top != 0)
 	 Top = Top->Next;
-      delete Tmp;
+      DeleteItem(Tmp);
    }
 }
 									/*}}}*/
@@ -699,6 +818,10 @@ bool Configuration::Exists(const char *Name) const
    if (Itm == 0)
       return false;
    return true;
+}
+bool Configuration::Exists(Key const &K) const
+{
+   return Lookup(K) != 0;
 }
 									/*}}}*/
 // Configuration::ExistsAny - Returns true if the Name, possibly	/*{{{*/
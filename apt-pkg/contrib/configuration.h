@@ -17,6 +17,10 @@
    Most things can get by quite happily with,
      cout << _config->Find("Foo::Bar") << endl;
 
+   Code asking for the same option over and over again can create a
+   Configuration::Key for it once to skip parsing and hashing the name
+   on each lookup.
+
    A special extension, support for ordered lists is provided by using the
    special syntax, "block::list::" the trailing :: designates the 
    item as a list. To access the list you must use the tree function on
@@ -31,6 +35,7 @@
 
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <apt-pkg/macros.h>
@@ -52,6 +57,25 @@ class APT_PUBLIC Configuration
       
       Item() : Parent(0), Child(0), Next(0) {};
    };
+
+   /** \brief a precompiled option name
+    *
+    * The name is split into its scopes and their hashes are computed
+    * once, so a lookup with a key is just a hash probe per scope.
+    * Keys do not refer to a specific configuration or item, so they
+    * can be reused freely, e.g. as static constants.
+    */
+   class APT_PUBLIC Key
+   {
+      std::string Name;
+      std::vector<std::pair<std::string, size_t>> Scopes;
+      friend class Configuration;
+
+      public:
+      explicit Key(char const * const Option);
+      explicit Key(std::string const &Option) : Key(Option.c_str()) {};
+      std::string const &FullName() const { return Name; };
+   };
    
    private:
    
@@ -64,6 +88,7 @@ class APT_PUBLIC Configuration
    {
       return const_cast<Configuration *>(this)->Lookup(Name,false);
    }  
+   APT_HIDDEN const Item *Lookup(Key const &K) const;
    
    public:
 
@@ -88,6 +113,9 @@ class APT_PUBLIC Configuration
    bool FindB(const char *Name,bool const &Default = false) const;
    bool FindB(std::string const &Name,bool const &Default = false) const {return FindB(Name.c_str(),Default);};
    std::string FindAny(const char *Name,const char *Default = 0) const;
+   std::string Find(Key const &K,const char *Default = 0) const;
+   int FindI(Key const &K,int const &Default = 0) const;
+   bool FindB(Key const &K,bool const &Default = false) const;
 	      
    inline void Set(const std::string &Name,const std::string &Value) {Set(Name.c_str(),Value);};
    void CndSet(const char *Name,const std::string &Value);
@@ -97,6 +125,7 @@ class APT_PUBLIC Configuration
    
    inline bool Exists(const std::string &Name) const {return Exists(Name.c_str());};
    bool Exists(const char *Name) const;
+   bool Exists(Key const &K) const;
    bool ExistsAny(const char *Name) const;
 
    void MoveSubTree(char const * const OldRoot, char const * const NewRoot);
@@ -14,6 +14,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -21,6 +22,7 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -38,6 +40,41 @@ static std::unique_ptr<FILE, decltype(&fclose)> make_unique_FILE(std::string con
    return {fopen(filename.c_str(), mode), &fclose};
 }
 
+// OpenMemoryFile - anonymous file in memory a subprocess can open	/*{{{*/
+// ---------------------------------------------------------------------
+/* The file is reachable for gpgv via /dev/fd as long as the descriptor is
+   inherited, so it is placed above the given descriptor we will dup2 over.
+   Returns false if memory files are unavailable, e.g. /proc isn't mounted. */
+static bool OpenMemoryFile(char const * const Name, int const MinFd, FileFd &File, std::string &Path)
+{
+#ifdef HAVE_MEMFD_CREATE
+   int const memfd = memfd_create(Name, 0);
+   if (memfd == -1)
+      return false;
+   int const fd = fcntl(memfd, F_DUPFD, std::max(MinFd, STDERR_FILENO) + 1);
+   close(memfd);
+   if (fd == -1)
+      return false;
+   Path = "/dev/fd/" + std::to_string(fd);
+   if (access(Path.c_str(), R_OK) != 0)
+   {
+      close(fd);
+      return false;
+   }
+   if (File.OpenDescriptor(fd, FileFd::ReadWrite, true) == false)
+      return false;
+   // FileFd marks its descriptors close-on-exec, but gpgv has to inherit it
+   SetCloseExec(fd, false);
+   return true;
+#else
+   (void)Name;
+   (void)MinFd;
+   (void)File;
+   (void)Path;
+   return false;
+#endif
+}
+									/*}}}*/
 class LineBuffer							/*{{{*/
 {
    char *buffer = nullptr;
@@ -225,6 +262,9 @@ void ExecGPGV(std::string const &File, std::string const &FileGPG,
    auto sig = make_unique_char();
    auto data = make_unique_char();
    auto conf = make_unique_char();
+   std::set<int> KeepFDs;
+   // kept open until gpgv is done as it might read from them via /dev/fd
+   FileFd signature, message;
 
    // Dump the configuration so apt-key picks up the correct Dir values
    {
@@ -333,16 +373,29 @@ void ExecGPGV(std::string const &File, std::string const &FileGPG,
    }
    else // clear-signed file
    {
-      FileFd signature;
-      if (GetTempFile("apt.sig", false, &signature) == nullptr)
-	 local_exit(EINTERNAL);
-      sig.reset(strdup(signature.Name().c_str()));
-      local_exit.files.push_back(sig.get());
-      FileFd message;
-      if (GetTempFile("apt.data", false, &message) == nullptr)
-	 local_exit(EINTERNAL);
-      data.reset(strdup(message.Name().c_str()));
-      local_exit.files.push_back(data.get());
+      // prefer splitting into memory, there is no need to hit the disk
+      std::string sigPath, dataPath;
+      if (OpenMemoryFile("apt.sig", statusfd, signature, sigPath) &&
+	  OpenMemoryFile("apt.data", statusfd, message, dataPath))
+      {
+	 KeepFDs.insert(signature.Fd());
+	 KeepFDs.insert(message.Fd());
+	 sig.reset(strdup(sigPath.c_str()));
+	 data.reset(strdup(dataPath.c_str()));
+      }
+      else
+      {
+	 signature.Close();
+	 if (GetTempFile("apt.sig", false, &signature) == nullptr)
+	    local_exit(EINTERNAL);
+	 sig.reset(strdup(signature.Name().c_str()));
+	 local_exit.files.push_back(sig.get());
+	 message.Close();
+	 if (GetTempFile("apt.data", false, &message) == nullptr)
+	    local_exit(EINTERNAL);
+	 data.reset(strdup(message.Name().c_str()));
+	 local_exit.files.push_back(data.get());
+      }
 
       if (signature.Failed() || message.Failed() ||
 	  not SplitClearSignedFile(File, &message, nullptr, &signature))
@@ -384,7 +437,8 @@ void ExecGPGV(std::string const &File, std::string const &FileGPG,
 
    // We have created tempfiles we have to clean up
    // and we do an additional check, so fork yet another time …
-   pid_t pid = ExecFork();
+   MergeKeepFdsFromConfiguration(KeepFDs);
+   pid_t pid = ExecFork(KeepFDs);
    if(pid < 0) {
       apt_error(std::cerr, statusfd, fd, "Fork failed for %s to check %s", Args[0], File.c_str());
       local_exit(EINTERNAL);
@@ -246,7 +246,10 @@ DynamicMMap::DynamicMMap(FileFd &F,unsigned long Flags,unsigned long const &Work
 // ---------------------------------------------------------------------
 /* We try here to use mmap to reserve some space - this is much more
    cooler than the fallback solution to simply allocate a char array
-   and could come in handy later than we are able to grow such an mmap */
+   and could come in handy later than we are able to grow such an mmap.
+   With Reserve the WorkSpace is only reserved as address space: Pages are
+   provided by the kernel on first use, so a generous WorkSpace doesn't cost
+   memory, but saves us from growing (and moving) the map later on. */
 DynamicMMap::DynamicMMap(unsigned long Flags,unsigned long const &WorkSpace,
 			 unsigned long const &Grow, unsigned long const &Limit) :
 		MMap(Flags | NoImmMap | UnMapped), Fd(0), WorkSpace(WorkSpace),
@@ -279,6 +282,10 @@ DynamicMMap::DynamicMMap(unsigned long Flags,unsigned long const &WorkSpace,
 #else
 			Map = MAP_SHARED | MAP_ANON;
 #endif
+#ifdef MAP_NORESERVE
+		if ((this->Flags & Reserve) == Reserve)
+			Map |= MAP_NORESERVE;
+#endif
 
 		// use anonymous mmap() to get the memory
 		Base = (unsigned char*) mmap(0, WorkSpace, Prot, Map, -1, 0);
@@ -459,7 +466,14 @@ bool DynamicMMap::Grow() {
 	if (GrowFactor <= 0)
 		return _error->Error(_("Unable to increase size of the MMap as automatic growing is disabled by user."));
 
-	unsigned long long const newSize = WorkSpace + GrowFactor;
+	unsigned long long newSize = WorkSpace + GrowFactor;
+	// the reservation was too small, so grow geometrically to move rarely
+	if ((Flags & Reserve) == Reserve && WorkSpace > GrowFactor)
+	{
+		newSize = 2ull * WorkSpace;
+		if (Limit != 0 && newSize > Limit)
+			newSize = Limit;
+	}
 
 	if(Fd != 0) {
 		Fd->Seek(newSize - 1);
@@ -56,7 +56,8 @@ class MMap
    public:
 
    enum OpenFlags {NoImmMap = (1<<0),Public = (1<<1),ReadOnly = (1<<2),
-                   UnMapped = (1<<3), Moveable = (1<<4), Fallback = (1 << 5)};
+                   UnMapped = (1<<3), Moveable = (1<<4), Fallback = (1 << 5),
+                   Reserve = (1 << 6)};
       
    // Simple accessors
    inline operator void *() {return Base;};
@@ -246,6 +246,11 @@ bool debListParser::NewVersion(pkgCache::VerIterator &Ver)
    
    if (ParseProvides(Ver) == false)
       return false;
+
+   if (ParseFieldValues(Ver, pkgTagSection::Key::Task, "Task") == false)
+      return false;
+   if (ParseFieldValues(Ver, pkgTagSection::Key::Tag, "Tag") == false)
+      return false;
    
    return true;
 }
@@ -563,6 +568,18 @@ const char *debListParser::ParseDepends(const char *Start, const char *Stop,
 {
    if (Arch.empty())
       Arch = _config->Find("APT::Architecture");
+   return ParseDependency(Start, Stop, Package, Ver, Op, ParseArchFlags,
+			  StripMultiArch, ParseRestrictionsList, Arch);
+}
+/* The workhorse: all results point into the given buffer and the
+   architecture is only looked at, so parsing a relation allocates nothing
+   unless architecture or restriction lists have to be evaluated. */
+const char *debListParser::ParseDependency(const char *Start, const char *Stop,
+					   StringView &Package, StringView &Ver,
+					   unsigned int &Op, bool const ParseArchFlags,
+					   bool const StripMultiArch,
+					   bool const ParseRestrictionsList, StringView const Arch)
+{
    // Strip off leading space
    for (;Start != Stop && isspace_ascii(*Start) != 0; ++Start);
    
@@ -629,7 +646,7 @@ const char *debListParser::ParseDepends(const char *Start, const char *Stop,
 
    if (unlikely(ParseArchFlags == true))
    {
-      APT::CacheFilter::PackageArchitectureMatchesSpecification matchesArch(Arch, false);
+      APT::CacheFilter::PackageArchitectureMatchesSpecification matchesArch(Arch.to_string(), false);
 
       // Parse an architecture
       if (I != Stop && *I == '[')
@@ -810,7 +827,7 @@ bool debListParser::ParseDepends(pkgCache::VerIterator &Ver,
       StringView Version;
       unsigned int Op;
 
-      Start = ParseDepends(Start, Stop, Package, Version, Op, false, false, false, myArch);
+      Start = ParseDependency(Start, Stop, Package, Version, Op, false, false, false, myArch);
       if (Start == 0)
 	 return _error->Error("Problem parsing dependency %zu of %s:%s=%s", static_cast<size_t>(Key), // TODO
 			      Ver.ParentPkg().Name(), Ver.Arch(), Ver.VerStr());
@@ -878,7 +895,7 @@ bool debListParser::ParseProvides(pkgCache::VerIterator &Ver)
 
       do
       {
-	 Start = ParseDepends(Start,Stop,Package,Version,Op, false, false, false);
+	 Start = ParseDependency(Start, Stop, Package, Version, Op, false, false, false, myArch);
 	 const size_t archfound = Package.rfind(':');
 	 if (Start == 0)
 	    return _error->Error("Problem parsing Provides line of %s:%s=%s", Ver.ParentPkg().Name(), Ver.Arch(), Ver.VerStr());
@@ -952,6 +969,30 @@ bool debListParser::ParseProvides(pkgCache::VerIterator &Ver)
    return true;
 }
 									/*}}}*/
+// ListParser::ParseFieldValues - Index the values of a list field	/*{{{*/
+// ---------------------------------------------------------------------
+/* Fields like Task are comma-separated lists of words we want to find
+   packages by, so each value is stored in the index of the cache */
+bool debListParser::ParseFieldValues(pkgCache::VerIterator &Ver, pkgTagSection::Key const Key,
+				     APT::StringView const Field)
+{
+   const char *Start;
+   const char *Stop;
+   if (Section.Find(Key, Start, Stop) == false)
+      return true;
+
+   while (Start != Stop)
+   {
+      for (; Start != Stop && (isspace_ascii(*Start) != 0 || *Start == ','); ++Start);
+      const char *End = Start;
+      for (; End != Stop && isspace_ascii(*End) == 0 && *End != ','; ++End);
+      if (End != Start && NewFieldValue(Ver, Field, APT::StringView(Start, End - Start)) == false)
+	 return false;
+      Start = End;
+   }
+   return true;
+}
+									/*}}}*/
 // ListParser::GrabWord - Matches a word and returns			/*{{{*/
 // ---------------------------------------------------------------------
 /* Looks for a word in a list of words - for ParseStatus */
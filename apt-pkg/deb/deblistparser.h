@@ -48,7 +48,14 @@ class APT_HIDDEN debListParser : public pkgCacheListParser
    bool ParseDepends(pkgCache::VerIterator &Ver, pkgTagSection::Key Key,
 		     unsigned int Type);
    bool ParseProvides(pkgCache::VerIterator &Ver);
-
+   APT_HIDDEN bool ParseFieldValues(pkgCache::VerIterator &Ver, pkgTagSection::Key const Key,
+				    APT::StringView const Field);
+
+   APT_HIDDEN static const char *ParseDependency(const char *Start, const char *Stop,
+						 APT::StringView &Package, APT::StringView &Ver,
+						 unsigned int &Op, bool const ParseArchFlags,
+						 bool const StripMultiArch, bool const ParseRestrictionsList,
+						 APT::StringView const Arch);
    APT_HIDDEN static bool GrabWord(APT::StringView Word,const WordList *List,unsigned char &Out);
    APT_HIDDEN unsigned char ParseMultiArch(bool const showErrors);
 
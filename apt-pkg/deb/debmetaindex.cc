@@ -422,6 +422,12 @@ void debReleaseIndex::AddComponent(std::string const &sourcesEntry,	/*{{{*/
 									/*}}}*/
 
 bool debReleaseIndex::Load(std::string const &Filename, std::string * const ErrorText)/*{{{*/
+{
+   return LoadRelease(Filename, ErrorText, true);
+}
+									/*}}}*/
+bool debReleaseIndex::LoadRelease(std::string const &Filename, std::string * const ErrorText,/*{{{*/
+				  bool const WithChecksums)
 {
    LoadedSuccessfully = TRI_NO;
    FileFd Fd;
@@ -490,7 +496,7 @@ bool debReleaseIndex::Load(std::string const &Filename, std::string * const Erro
    bool FoundHashSum = false;
    bool FoundStrongHashSum = false;
    auto const SupportedHashes = HashString::SupportedHashes();
-   for (int i=0; SupportedHashes[i] != NULL; i++)
+   for (int i=0; WithChecksums && SupportedHashes[i] != NULL; i++)
    {
       if (!Section.Find(SupportedHashes[i], Start, End))
 	 continue;
@@ -504,28 +510,32 @@ bool debReleaseIndex::Load(std::string const &Filename, std::string * const Erro
 	    return false;
 
 	 HashString const hs(SupportedHashes[i], Hash);
-         if (Entries.find(Name) == Entries.end())
-         {
-            metaIndex::checkSum *Sum = new metaIndex::checkSum;
-            Sum->MetaKeyFilename = Name;
-            Sum->Size = Size;
+	 auto &Sum = Entries[Name];
+	 if (Sum == nullptr)
+	 {
+	    Sum = new metaIndex::checkSum;
+	    Sum->MetaKeyFilename = Name;
+	    Sum->Size = Size;
 	    Sum->Hashes.FileSize(Size);
-	    Entries[Name] = Sum;
-         }
-         Entries[Name]->Hashes.push_back(hs);
+	 }
+	 Sum->Hashes.push_back(hs);
          FoundHashSum = true;
 	 if (FoundStrongHashSum == false && hs.usable() == true)
 	    FoundStrongHashSum = true;
       }
    }
 
+   // without checksums we can't authenticate anything
    bool AuthPossible = false;
-   if(FoundHashSum == false)
-      _error->Warning(_("No Hash entry in Release file %s"), Filename.c_str());
-   else if(FoundStrongHashSum == false)
-      _error->Warning(_("No Hash entry in Release file %s which is considered strong enough for security purposes"), Filename.c_str());
-   else
-      AuthPossible = true;
+   if (WithChecksums)
+   {
+      if(FoundHashSum == false)
+	 _error->Warning(_("No Hash entry in Release file %s"), Filename.c_str());
+      else if(FoundStrongHashSum == false)
+	 _error->Warning(_("No Hash entry in Release file %s which is considered strong enough for security purposes"), Filename.c_str());
+      else
+	 AuthPossible = true;
+   }
 
    std::string const StrDate = Section.FindS("Date");
    if (RFC1123StrToTime(StrDate, Date) == false)
@@ -621,7 +631,7 @@ bool debReleaseIndex::Load(std::string const &Filename, std::string * const Erro
 
    if (AuthPossible)
       LoadedSuccessfully = TRI_YES;
-   return AuthPossible;
+   return AuthPossible || WithChecksums == false;
 }
 									/*}}}*/
 time_t debReleaseIndex::GetNotBefore() const /*{{{*/
@@ -1239,9 +1249,10 @@ class APT_HIDDEN debSLTypeDebian : public pkgSourceList::Type		/*{{{*/
 	 std::string filename;
 	 if (ReleaseFileName(Deb, filename))
 	 {
-	    auto OldDeb = Deb->UnloadedClone();
+	    // we only need the header, the checksums are big and not needed
+	    auto OldDeb = static_cast<debReleaseIndex *>(Deb->UnloadedClone());
 	    _error->PushToStack();
-	    OldDeb->Load(filename, nullptr);
+	    OldDeb->LoadRelease(filename, nullptr, false);
 	    bool const goodLoad = _error->PendingError() == false;
 	    _error->RevertToStack();
 	    if (goodLoad)
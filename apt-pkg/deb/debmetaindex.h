@@ -41,6 +41,12 @@ class APT_HIDDEN debReleaseIndex : public metaIndex
    virtual bool Merge(pkgCacheGenerator &Gen,OpProgress *Prog) const APT_OVERRIDE;
 
    virtual bool Load(std::string const &Filename, std::string * const ErrorText) APT_OVERRIDE;
+   /** \brief #Load, but optionally skipping the checksum tables
+    *
+    * Without checksums the index is never considered successfully loaded,
+    * but all other fields of the Release file are available.
+    */
+   APT_HIDDEN bool LoadRelease(std::string const &Filename, std::string * const ErrorText, bool const WithChecksums);
    virtual metaIndex * UnloadedClone() const APT_OVERRIDE;
 
    virtual std::vector <pkgIndexFile *> *GetIndexFiles() APT_OVERRIDE;
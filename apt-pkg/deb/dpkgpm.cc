@@ -106,7 +106,7 @@ public:
 			dpkgbuf_pos(0), term_out(NULL), history_out(NULL),
 			progress(NULL), tt_is_valid(false), master(-1),
 			slave(NULL), protect_slave_from_dying(-1),
-			direct_stdin(false)
+			direct_stdin(false), debug_progress(false)
    {
       dpkgbuf[0] = '\0';
    }
@@ -135,6 +135,16 @@ public:
    sigset_t original_sigmask;
 
    bool direct_stdin;
+
+   // PackageOps and PackageOpsDone entries by package ID, so that lines
+   // from the status-fd can be matched without building names
+   struct PackageProgress
+   {
+      std::vector<pkgDPkgPM::DpkgState> *Ops;
+      unsigned int *Done;
+   };
+   std::vector<PackageProgress> progressmap;
+   bool debug_progress;
 };
 									/*}}}*/
 namespace
@@ -159,17 +169,17 @@ namespace
   // array matches a string.
   class MatchProcessingOp
   {
-    const char *target;
+    APT::StringView target;
 
   public:
-    explicit MatchProcessingOp(const char *the_target)
+    explicit MatchProcessingOp(APT::StringView the_target)
       : target(the_target)
     {
     }
 
     bool operator()(const std::pair<const char *, const char *> &pair) const
     {
-      return strcmp(pair.first, target) == 0;
+      return target == pair.first;
     }
   };
 }
@@ -575,9 +585,17 @@ void pkgDPkgPM::DoTerminalPty(int master)
 }
 									/*}}}*/
 // DPkgPM::ProcessDpkgStatusBuf						/*{{{*/
+static APT::StringView StripStatusField(APT::StringView field)
+{
+   while (field.empty() == false && isspace_ascii(field[0]) != 0)
+      field = field.substr(1);
+   while (field.empty() == false && isspace_ascii(field[field.size() - 1]) != 0)
+      field = field.substr(0, field.size() - 1);
+   return field;
+}
 void pkgDPkgPM::ProcessDpkgStatusLine(char *line)
 {
-   bool const Debug = _config->FindB("Debug::pkgDPkgProgressReporting",false);
+   bool const Debug = d->debug_progress;
    if (Debug == true)
       std::clog << "got from dpkg '" << line << "'" << std::endl;
 
@@ -595,8 +613,21 @@ void pkgDPkgPM::ProcessDpkgStatusLine(char *line)
    // A dpkg error message may contain additional ":" (like
    //  "failed in buffer_write(fd) (10, ret=-1): backend dpkg-deb ..."
    // so we need to ensure to not split too much
-   std::vector<std::string> list = StringSplit(line, ": ", 4);
-   if(list.size() < 3)
+   std::array<APT::StringView, 4> list;
+   size_t listsize = 0;
+   {
+      APT::StringView rest(line);
+      for (; listsize < list.size() - 1; ++listsize)
+      {
+	 auto const sep = static_cast<char const *>(memmem(rest.data(), rest.size(), ": ", 2));
+	 if (sep == nullptr)
+	    break;
+	 list[listsize] = rest.substr(0, sep - rest.data());
+	 rest = rest.substr(sep - rest.data() + 2);
+      }
+      list[listsize++] = rest;
+   }
+   if(listsize < 3)
    {
       if (Debug == true)
 	 std::clog << "ignoring line: not enough ':'" << std::endl;
@@ -605,25 +636,26 @@ void pkgDPkgPM::ProcessDpkgStatusLine(char *line)
 
    // build the (prefix, pkgname, action) tuple, position of this
    // is different for "processing" or "status" messages
-   std::string prefix = APT::String::Strip(list[0]);
-   std::string pkgname;
-   std::string action;
+   APT::StringView const prefix = StripStatusField(list[0]);
+   APT::StringView pkgname;
+   APT::StringView action;
 
    // "processing" has the form "processing: action: pkg or trigger"
    // with action = ["install", "upgrade", "configure", "remove", "purge",
    //                "disappear", "trigproc"]
-   if (prefix == "processing")
+   bool const processing = (prefix == "processing");
+   if (processing)
    {
-      pkgname = APT::String::Strip(list[2]);
-      action = APT::String::Strip(list[1]);
+      pkgname = StripStatusField(list[2]);
+      action = StripStatusField(list[1]);
    }
    // "status" has the form: "status: pkg: state"
    // with state in ["half-installed", "unpacked", "half-configured",
    //                "installed", "config-files", "not-installed"]
    else if (prefix == "status")
    {
-      pkgname = APT::String::Strip(list[1]);
-      action = APT::String::Strip(list[2]);
+      pkgname = StripStatusField(list[1]);
+      action = StripStatusField(list[2]);
 
       /* handle the special cases first:
 
@@ -634,116 +666,150 @@ void pkgDPkgPM::ProcessDpkgStatusLine(char *line)
 	 */
       if(action == "error")
       {
-         d->progress->Error(pkgname, PackagesDone, PackagesTotal, list[3]);
-         ++pkgFailures;
-         WriteApportReport(pkgname.c_str(), list[3].c_str());
-         return;
+	 std::string const name = pkgname.to_string();
+	 std::string const msg = listsize > 3 ? list[3].to_string() : "";
+	 d->progress->Error(name, PackagesDone, PackagesTotal, msg);
+	 ++pkgFailures;
+	 WriteApportReport(name.c_str(), msg.c_str());
+	 return;
       }
       else if(action == "conffile-prompt")
       {
-         d->progress->ConffilePrompt(pkgname, PackagesDone, PackagesTotal, list[3]);
-         return;
+	 d->progress->ConffilePrompt(pkgname.to_string(), PackagesDone, PackagesTotal, listsize > 3 ? list[3].to_string() : "");
+	 return;
       }
    } else {
       if (Debug == true)
-	 std::clog << "unknown prefix '" << prefix << "'" << std::endl;
+	 std::clog << "unknown prefix '" << prefix.to_string() << "'" << std::endl;
       return;
    }
 
+   // the states of the packages we act on are indexed by ID, others are
+   // tracked by name like before
+   auto const PackageProgress = [&](pkgCache::PkgIterator const &P) {
+      auto &&progress = d->progressmap[P->ID];
+      if (progress.Ops == nullptr)
+      {
+	 std::string const name = P.FullName();
+	 progress.Ops = &PackageOps[name];
+	 progress.Done = &PackageOpsDone[name];
+      }
+      return progress;
+   };
+   auto const HasPackageOps = [&](pkgCache::PkgIterator const &P) {
+      return d->progressmap[P->ID].Ops != nullptr;
+   };
+   if (d->progressmap.size() < Cache.Head().PackageCount)
+      d->progressmap.resize(Cache.Head().PackageCount, {nullptr, nullptr});
+
    // At this point we have a pkgname, but it might not be arch-qualified !
-   if (pkgname.find(":") == std::string::npos)
+   pkgCache::PkgIterator Pkg;
+   if (pkgname.find(':') == APT::StringView::npos)
    {
       pkgCache::GrpIterator const Grp = Cache.FindGrp(pkgname);
       if (unlikely(Grp.end()== true))
       {
 	 if (Debug == true)
-	    std::clog << "unable to figure out which package is dpkg referring to with '" << pkgname << "'! (0)" << std::endl;
+	    std::clog << "unable to figure out which package is dpkg referring to with '" << pkgname.to_string() << "'! (0)" << std::endl;
 	 return;
       }
       /* No arch means that dpkg believes there can only be one package
          this can refer to so lets see what could be candidates here: */
-      std::vector<pkgCache::PkgIterator> candset;
-      for (auto P = Grp.PackageList(); P.end() != true; P = Grp.NextPkg(P))
-      {
-	 if (PackageOps.find(P.FullName()) != PackageOps.end())
-	    candset.push_back(P);
+      auto const IsCandidate = [&](pkgCache::PkgIterator const &P) {
+	 if (HasPackageOps(P))
+	    return true;
 	 // packages can disappear without them having any interaction itself
 	 // so we have to consider these as candidates, too
-	 else if (P->CurrentVer != 0 && action == "disappear")
-	    candset.push_back(P);
+	 return P->CurrentVer != 0 && action == "disappear";
+      };
+      size_t candsize = 0;
+      for (auto P = Grp.PackageList(); P.end() != true; P = Grp.NextPkg(P))
+      {
+	 if (IsCandidate(P) == false)
+	    continue;
+	 if (candsize++ == 0)
+	    Pkg = P;
       }
-      if (unlikely(candset.empty()))
+      if (unlikely(candsize == 0))
       {
 	 if (Debug == true)
-	    std::clog << "unable to figure out which package is dpkg referring to with '" << pkgname << "'! (1)" << std::endl;
+	    std::clog << "unable to figure out which package is dpkg referring to with '" << pkgname.to_string() << "'! (1)" << std::endl;
 	 return;
       }
-      else if (candset.size() == 1) // we are lucky
-	 pkgname = candset.cbegin()->FullName();
-      else
+      // with only one candidate we are lucky, otherwise guess
+      else if (candsize != 1)
       {
+	 Pkg = pkgCache::PkgIterator();
+	 std::vector<pkgCache::PkgIterator> candset;
+	 candset.reserve(candsize);
+	 for (auto P = Grp.PackageList(); P.end() != true; P = Grp.NextPkg(P))
+	    if (IsCandidate(P))
+	       candset.push_back(P);
+	 auto const candbegin = candset.begin();
+	 auto const candend = candset.end();
+
 	 /* here be dragons^Wassumptions about dpkg:
 	    - an M-A:same version is always arch-qualified
 	    - a package from a foreign arch is (in newer versions) */
 	 size_t installedInstances = 0, wannabeInstances = 0;
-	 for (auto const &P: candset)
+	 for (auto P = candbegin; P != candend; ++P)
 	 {
-	    if (P->CurrentVer != 0)
+	    if ((*P)->CurrentVer != 0)
 	    {
 	       ++installedInstances;
-	       if (Cache[P].Delete() == false)
+	       if (Cache[*P].Delete() == false)
 		  ++wannabeInstances;
 	    }
-	    else if (Cache[P].Install())
+	    else if (Cache[*P].Install())
 	       ++wannabeInstances;
 	 }
 	 // the package becomes M-A:same, so we are still talking about current
 	 if (installedInstances == 1 && wannabeInstances >= 2)
 	 {
-	    for (auto const &P: candset)
+	    for (auto P = candbegin; P != candend; ++P)
 	    {
-	       if (P->CurrentVer == 0)
+	       if ((*P)->CurrentVer == 0)
 		  continue;
-	       pkgname = P.FullName();
+	       Pkg = *P;
 	       break;
 	    }
 	 }
 	 // the package was M-A:same, it isn't now, so we can only talk about that
 	 else if (installedInstances >= 2 && wannabeInstances == 1)
 	 {
-	    for (auto const &P: candset)
+	    for (auto P = candbegin; P != candend; ++P)
 	    {
-	       auto const IV = Cache[P].InstVerIter(Cache);
+	       auto const IV = Cache[*P].InstVerIter(Cache);
 	       if (IV.end())
 		  continue;
-	       pkgname = P.FullName();
+	       Pkg = *P;
 	       break;
 	    }
 	 }
 	 // that is a crossgrade
-	 else if (installedInstances == 1 && wannabeInstances == 1 && candset.size() == 2)
+	 else if (installedInstances == 1 && wannabeInstances == 1 && candsize == 2)
 	 {
 	    auto const PkgHasCurrentVersion = [](pkgCache::PkgIterator const &P) { return P->CurrentVer != 0; };
-	    auto const P = std::find_if(candset.begin(), candset.end(), PkgHasCurrentVersion);
-	    if (unlikely(P == candset.end()))
+	    auto const P = std::find_if(candbegin, candend, PkgHasCurrentVersion);
+	    if (unlikely(P == candend))
 	    {
 	       if (Debug == true)
-		  std::clog << "situation for '" << pkgname << "' looked like a crossgrade, but no current version?!" << std::endl;
+		  std::clog << "situation for '" << pkgname.to_string() << "' looked like a crossgrade, but no current version?!" << std::endl;
 	       return;
 	    }
-	    auto fullname = P->FullName();
-	    if (PackageOps[fullname].size() != PackageOpsDone[fullname])
-	       pkgname = std::move(fullname);
+	    auto const progress = PackageProgress(*P);
+	    if (progress.Ops->size() != *progress.Done)
+	       Pkg = *P;
 	    else
 	    {
-	       auto const pkgi = std::find_if_not(candset.begin(), candset.end(), PkgHasCurrentVersion);
-	       if (unlikely(pkgi == candset.end()))
+	       auto const pkgi = std::find_if_not(candbegin, candend, PkgHasCurrentVersion);
+	       if (unlikely(pkgi == candend))
 	       {
 		  if (Debug == true)
-		     std::clog << "situation for '" << pkgname << "' looked like a crossgrade, but all are installed?!" << std::endl;
+		     std::clog << "situation for '" << pkgname.to_string() << "' looked like a crossgrade, but all are installed?!" << std::endl;
 		  return;
 	       }
-	       pkgname = pkgi->FullName();
+	       Pkg = *pkgi;
 	    }
 	 }
 	 // we are desperate: so "just" take the native one, but that might change mid-air,
@@ -757,7 +823,7 @@ void pkgDPkgPM::ProcessDpkgStatusLine(char *line)
 	    if (unlikely(dpkgNativeArch == -1))
 	    {
 	       if (Debug == true)
-		  std::clog << "calling dpkg failed to ask it for its current native architecture to expand '" << pkgname << "'!" << std::endl;
+		  std::clog << "calling dpkg failed to ask it for its current native architecture to expand '" << pkgname.to_string() << "'!" << std::endl;
 	       return;
 	    }
 	    FILE *dpkg = fdopen(outputFd, "r");
@@ -766,106 +832,105 @@ void pkgDPkgPM::ProcessDpkgStatusLine(char *line)
 	       char* buf = NULL;
 	       size_t bufsize = 0;
 	       if (getline(&buf, &bufsize, dpkg) != -1)
-		  pkgname += ':' + bufsize;
+		  Pkg = Grp.FindPkg(StripStatusField(buf));
 	       free(buf);
 	       fclose(dpkg);
 	    }
 	    ExecWait(dpkgNativeArch, "dpkg --print-architecture", true);
-	    if (pkgname.find(':') != std::string::npos)
-	    {
-	       if (Debug == true)
-		  std::clog << "unable to figure out which package is dpkg referring to with '" << pkgname << "'! (2)" << std::endl;
-	       return;
-	    }
 	 }
       }
    }
+   else
+      Pkg = Cache.FindPkg(pkgname);
+   if (unlikely(Pkg.end() == true))
+   {
+      if (Debug == true)
+	 std::clog << "unable to figure out which package is dpkg referring to with '" << pkgname.to_string() << "'! (2)" << std::endl;
+      return;
+   }
 
-   std::string arch = "";
-   if (pkgname.find(":") != string::npos)
-      arch = StringSplit(pkgname, ":")[1];
-   std::string i18n_pkgname = pkgname;
-   if (arch.size() != 0)
-      strprintf(i18n_pkgname, "%s (%s)", StringSplit(pkgname, ":")[0].c_str(), arch.c_str());
+   // the human readable name for the progress report is only needed if we report
+   auto const TranslatedMessage = [&](char const * const format) {
+      std::string i18n_pkgname, msg;
+      strprintf(i18n_pkgname, "%s (%s)", Pkg.Name(), Pkg.Arch());
+      strprintf(msg, format, i18n_pkgname.c_str());
+      return msg;
+   };
 
    // 'processing' from dpkg looks like
    // 'processing: action: pkg'
-   if(prefix == "processing")
+   if(processing)
    {
-      auto const iter = std::find_if(PackageProcessingOpsBegin, PackageProcessingOpsEnd, MatchProcessingOp(action.c_str()));
+      auto const iter = std::find_if(PackageProcessingOpsBegin, PackageProcessingOpsEnd, MatchProcessingOp(action));
       if(iter == PackageProcessingOpsEnd)
       {
 	 if (Debug == true)
-	    std::clog << "ignoring unknown action: " << action << std::endl;
+	    std::clog << "ignoring unknown action: " << action.to_string() << std::endl;
 	 return;
       }
-      std::string msg;
-      strprintf(msg, _(iter->second), i18n_pkgname.c_str());
-      d->progress->StatusChanged(pkgname, PackagesDone, PackagesTotal, msg);
+      std::string const fullname = Pkg.FullName();
+      d->progress->StatusChanged(fullname, PackagesDone, PackagesTotal, TranslatedMessage(_(iter->second)));
 
       // FIXME: this needs a muliarch testcase
       // FIXME2: is "pkgname" here reliable with dpkg only sending us
       //         short pkgnames?
       if (action == "disappear")
-	 handleDisappearAction(pkgname);
+	 handleDisappearAction(fullname);
       else if (action == "upgrade")
-	 handleCrossUpgradeAction(pkgname);
+	 handleCrossUpgradeAction(fullname);
       return;
    }
 
-   if (prefix == "status")
+   auto const progress = PackageProgress(Pkg);
+   std::vector<struct DpkgState> &states = *progress.Ops;
+   unsigned int &done = *progress.Done;
+   if(done < states.size())
    {
-      std::vector<struct DpkgState> &states = PackageOps[pkgname];
-      if(PackageOpsDone[pkgname] < states.size())
+      char const * next_action = states[done].state;
+      if (next_action)
       {
-	 char const * next_action = states[PackageOpsDone[pkgname]].state;
-	 if (next_action)
+	 /*
+	 if (action == "half-installed" && strcmp("half-configured", next_action) == 0 &&
+	       PackageOpsDone[pkg] + 2 < states.size() && action == states[PackageOpsDone[pkg] + 2].state)
 	 {
-	    /*
-	    if (action == "half-installed" && strcmp("half-configured", next_action) == 0 &&
-		  PackageOpsDone[pkg] + 2 < states.size() && action == states[PackageOpsDone[pkg] + 2].state)
-	    {
-	       if (Debug == true)
-		  std::clog << "(parsed from dpkg) pkg: " << short_pkgname << " action: " << action
-		     << " pending trigger defused by unpack" << std::endl;
-	       // unpacking a package defuses the pending trigger
-	       PackageOpsDone[pkg] += 2;
-	       PackagesDone += 2;
-	       next_action = states[PackageOpsDone[pkg]].state;
-	    }
-	    */
 	    if (Debug == true)
-	       std::clog << "(parsed from dpkg) pkg: " << pkgname
-		  << " action: " << action << " (expected: '" << next_action << "' "
-		  << PackageOpsDone[pkgname] << " of " << states.size() << ")" << endl;
+	       std::clog << "(parsed from dpkg) pkg: " << short_pkgname << " action: " << action
+		  << " pending trigger defused by unpack" << std::endl;
+	    // unpacking a package defuses the pending trigger
+	    PackageOpsDone[pkg] += 2;
+	    PackagesDone += 2;
+	    next_action = states[PackageOpsDone[pkg]].state;
+	 }
+	 */
+	 if (Debug == true)
+	    std::clog << "(parsed from dpkg) pkg: " << Pkg.FullName()
+	       << " action: " << action.to_string() << " (expected: '" << next_action << "' "
+	       << done << " of " << states.size() << ")" << endl;
 
-	    // check if the package moved to the next dpkg state
-	    if(action == next_action)
-	    {
-	       // only read the translation if there is actually a next action
-	       char const * const translation = _(states[PackageOpsDone[pkgname]].str);
+	 // check if the package moved to the next dpkg state
+	 if(action == next_action)
+	 {
+	    // only read the translation if there is actually a next action
+	    char const * const translation = _(states[done].str);
 
-	       // we moved from one dpkg state to a new one, report that
-	       ++PackageOpsDone[pkgname];
-	       ++PackagesDone;
+	    // we moved from one dpkg state to a new one, report that
+	    ++done;
+	    ++PackagesDone;
 
-	       std::string msg;
-	       strprintf(msg, translation, i18n_pkgname.c_str());
-	       d->progress->StatusChanged(pkgname, PackagesDone, PackagesTotal, msg);
-	    }
+	    d->progress->StatusChanged(Pkg.FullName(), PackagesDone, PackagesTotal, TranslatedMessage(translation));
 	 }
       }
-      else if (action == "triggers-pending")
-      {
-	 if (Debug == true)
-	    std::clog << "(parsed from dpkg) pkg: " << pkgname
-	       << " action: " << action << " (prefix 2 to "
-	       << PackageOpsDone[pkgname] << " of " << states.size() << ")" << endl;
+   }
+   else if (action == "triggers-pending")
+   {
+      if (Debug == true)
+	 std::clog << "(parsed from dpkg) pkg: " << Pkg.FullName()
+	    << " action: " << action.to_string() << " (prefix 2 to "
+	    << done << " of " << states.size() << ")" << endl;
 
-	 states.insert(states.begin(), {"installed", N_("Installed %s")});
-	 states.insert(states.begin(), {"half-configured", N_("Configuring %s")});
-	 PackagesTotal += 2;
-      }
+      states.insert(states.begin(), {"installed", N_("Installed %s")});
+      states.insert(states.begin(), {"half-configured", N_("Configuring %s")});
+      PackagesTotal += 2;
    }
 }
 									/*}}}*/
@@ -989,8 +1054,8 @@ void pkgDPkgPM::DoDpkgStatusFd(int statusfd)
    }
 
    // otherwise move the unprocessed tail to the start and update pos
-   memmove(d->dpkgbuf, p, (p - d->dpkgbuf));
    d->dpkgbuf_pos = (d->dpkgbuf + d->dpkgbuf_pos) - p;
+   memmove(d->dpkgbuf, p, d->dpkgbuf_pos);
 }
 									/*}}}*/
 // DPkgPM::WriteHistoryTag						/*{{{*/
@@ -1181,6 +1246,13 @@ void pkgDPkgPM::BuildPackagesProgressMap()
    // that will be [installed|configured|removed|purged] and add
    // them to the PackageOps map (the dpkg states it goes through)
    // and the PackageOpsTranslations (human readable strings)
+   // (starting from scratch as we might be called for multiple batches)
+   PackageOps.clear();
+   PackageOpsDone.clear();
+   PackagesDone = 0;
+   PackagesTotal = 0;
+   d->debug_progress = _config->FindB("Debug::pkgDPkgProgressReporting", false);
+   d->progressmap.assign(Cache.Head().PackageCount, {nullptr, nullptr});
    for (auto &&I : List)
    {
       if(I.Pkg.end() == true)
@@ -1188,6 +1260,7 @@ void pkgDPkgPM::BuildPackagesProgressMap()
 
       string const name = I.Pkg.FullName();
       PackageOpsDone[name] = 0;
+      d->progressmap[I.Pkg->ID] = {&PackageOps[name], &PackageOpsDone[name]};
       auto AddToPackageOps = [&](decltype(I.Op) const Op) {
 	 auto const DpkgOps = DpkgStatesOpMap[Op];
 	 std::copy(DpkgOps.begin(), DpkgOps.end(), std::back_inserter(PackageOps[name]));
@@ -1448,6 +1521,11 @@ bool pkgDPkgPM::ExpandPendingCalls(std::vector<Item> &List, pkgDepCache &Cache)
 }
 bool pkgDPkgPM::Go(APT::Progress::PackageManager *progress)
 {
+   /* nothing could be done in this round as the archives are still on
+      their way, so don't bother dpkg and the hooks */
+   if (IsWaitingForMissing() == true && List.empty() == true && Res == pkgPackageManager::Incomplete)
+      return true;
+
    struct Inhibitor
    {
       int Fd = -1;
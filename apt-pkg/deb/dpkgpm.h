@@ -30,6 +30,7 @@ class APT_PUBLIC pkgDPkgPM : public pkgPackageManager
 {
    private:
    pkgDPkgPMPrivate * const d;
+   friend class pkgDPkgPMPrivate;
 
    /** \brief record the disappear action and handle accordingly
 
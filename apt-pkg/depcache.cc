@@ -29,6 +29,7 @@
 #include <iostream>
 #include <iterator>
 #include <list>
+#include <memory>
 #include <set>
 #include <string>
 #include <utility>
@@ -92,13 +93,21 @@ pkgDepCache::ActionGroup::~ActionGroup()
   release();
 }
 									/*}}}*/
+struct pkgDepCache::Private						/*{{{*/
+{
+   /* The dependency states of a lazily initialized cache. They are only
+      handed over to DepState by the full pass, so that a DepState of NULL
+      tells the inline accessors that the full pass is still pending. */
+   std::unique_ptr<unsigned char[]> LazyDepState;
+};
+									/*}}}*/
 // DepCache::pkgDepCache - Constructors					/*{{{*/
 // ---------------------------------------------------------------------
 /* */
 pkgDepCache::pkgDepCache(pkgCache * const pCache,Policy * const Plcy) :
   group_level(0), Cache(pCache), PkgState(0), DepState(0),
    iUsrSize(0), iDownloadSize(0), iInstCount(0), iDelCount(0), iKeepCount(0),
-   iBrokenCount(0), iPolicyBrokenCount(0), iBadCount(0), d(NULL)
+   iBrokenCount(0), iPolicyBrokenCount(0), iBadCount(0), d(new Private())
 {
    DebugMarker = _config->FindB("Debug::pkgDepCache::Marker", false);
    DebugAutoInstall = _config->FindB("Debug::pkgDepCache::AutoInstall", false);
@@ -116,6 +125,7 @@ pkgDepCache::~pkgDepCache()
    delete [] PkgState;
    delete [] DepState;
    delete delLocalPolicy;
+   delete d;
 }
 									/*}}}*/
 // DepCache::Init - Generate the initial extra structures.		/*{{{*/
@@ -123,12 +133,16 @@ pkgDepCache::~pkgDepCache()
 /* This allocats the extension buffers and initializes them. */
 bool pkgDepCache::Init(OpProgress * const Prog)
 {
+   if (_config->FindB("APT::Cache::LazyDepCache", false) == true)
+      return InitLazy(Prog);
+
    // Suppress mark updates during this operation (just in case) and
    // run a mark operation when Init terminates.
    ActionGroup actions(*this);
 
    delete [] PkgState;
    delete [] DepState;
+   d->LazyDepState.reset();
    PkgState = new StateCache[Head().PackageCount];
    DepState = new unsigned char[Head().DependsCount];
    memset(PkgState,0,sizeof(*PkgState)*Head().PackageCount);
@@ -177,6 +191,113 @@ bool pkgDepCache::Init(OpProgress * const Prog)
    return true;
 }
 									/*}}}*/
+// DepCache::InitLazy - Init without computing any state yet		/*{{{*/
+// ---------------------------------------------------------------------
+/* Every package starts out kept at its current version with its candidate
+   and dependency state flagged as missing. operator[] fills them in for
+   the packages asked for, everything else waits for FinishLazyInit. */
+bool pkgDepCache::InitLazy(OpProgress * const Prog)
+{
+   delete [] PkgState;
+   delete [] DepState;
+   DepState = nullptr;
+   PkgState = new StateCache[Head().PackageCount];
+   d->LazyDepState.reset(new unsigned char[Head().DependsCount]);
+   memset(PkgState,0,sizeof(*PkgState)*Head().PackageCount);
+   memset(d->LazyDepState.get(),0,sizeof(*DepState)*Head().DependsCount);
+
+   if (Prog != 0)
+      Prog->OverallProgress(0,1,1,_("Building dependency tree"));
+
+   for (PkgIterator I = PkgBegin(); I.end() != true; ++I)
+   {
+      StateCache &State = PkgState[I->ID];
+      State.iFlags = LazyCandidate | LazyState;
+      State.InstallVer = I.CurrentVer();
+      State.Mode = ModeKeep;
+   }
+
+   readStateFile(Prog);
+
+   if (Prog != 0)
+      Prog->Done();
+
+   return true;
+}
+									/*}}}*/
+// DepCache::UpdateLazyCandidate - Choose the candidate of a package	/*{{{*/
+void pkgDepCache::UpdateLazyCandidate(PkgIterator const &Pkg)
+{
+   StateCache &State = PkgState[Pkg->ID];
+   if ((State.iFlags & LazyCandidate) == 0)
+      return;
+   State.iFlags &= ~LazyCandidate;
+   State.CandidateVer = LocalPolicy->GetCandidateVer(Pkg);
+   State.Update(Pkg,*this);
+}
+									/*}}}*/
+// DepCache::UpdateLazyState - Compute the state of a single package	/*{{{*/
+// ---------------------------------------------------------------------
+/* Dependencies are checked against the candidates of their targets and
+   providers, so those are chosen first. The counters are left to the
+   full pass as they sum up over all packages anyhow. */
+void pkgDepCache::UpdateLazyState(PkgIterator const &Pkg)
+{
+   StateCache &State = PkgState[Pkg->ID];
+   if ((State.iFlags & LazyState) == 0)
+      return;
+   State.iFlags &= ~LazyState;
+   UpdateLazyCandidate(Pkg);
+
+   for (VerIterator V = Pkg.VersionList(); V.end() != true; ++V)
+      for (DepIterator D = V.DependsList(); D.end() != true; ++D)
+      {
+	 PkgIterator const Target = D.TargetPkg();
+	 UpdateLazyCandidate(Target);
+	 for (auto const &P : Target.ProvidesRange())
+	    UpdateLazyCandidate(P.OwnerPkg());
+      }
+
+   DepState = d->LazyDepState.get();
+   UpdateDepends(Pkg);
+   UpdateVerState(Pkg);
+   DepState = nullptr;
+}
+									/*}}}*/
+// DepCache::FinishLazyInit - Perform the pass deferred by InitLazy	/*{{{*/
+void pkgDepCache::FinishLazyInit()
+{
+   if (DepState != nullptr || PkgState == nullptr)
+      return;
+
+   // Suppress mark updates during this operation and
+   // run a mark operation when we are done like Init does
+   ActionGroup actions(*this);
+
+   for (PkgIterator I = PkgBegin(); I.end() != true; ++I)
+   {
+      UpdateLazyCandidate(I);
+      PkgState[I->ID].iFlags &= ~LazyState;
+   }
+   DepState = d->LazyDepState.release();
+
+   iUsrSize = 0;
+   iDownloadSize = 0;
+   iInstCount = 0;
+   iDelCount = 0;
+   iKeepCount = 0;
+   iBrokenCount = 0;
+   iPolicyBrokenCount = 0;
+   iBadCount = 0;
+   for (PkgIterator I = PkgBegin(); I.end() != true; ++I)
+   {
+      UpdateDepends(I);
+      AddSizes(I);
+      UpdateVerState(I);
+      AddStates(I);
+   }
+}
+									/*}}}*/
 bool pkgDepCache::readStateFile(OpProgress * const Prog)		/*{{{*/
 {
    FileFd state_file;
@@ -347,6 +468,9 @@ bool pkgDepCache::writeStateFile(OpProgress * const /*prog*/, bool const Install
    set to the package which was used to satisfy the dep. */
 bool pkgDepCache::CheckDep(DepIterator const &Dep,int const Type,PkgIterator &Res)
 {
+   // the candidates of the targets and providers might not be chosen yet
+   if (Type == CandidateVersion)
+      RequireFullState();
    Res = Dep.TargetPkg();
 
    /* Check simple depends. A depends -should- never self match but 
@@ -376,8 +500,7 @@ bool pkgDepCache::CheckDep(DepIterator const &Dep,int const Type,PkgIterator &Re
       return false;
 
    // Check the providing packages
-   PrvIterator P = Dep.TargetPkg().ProvidesList();
-   for (; P.end() != true; ++P)
+   for (auto const &P : Dep.TargetPkg().ProvidesRange())
    {
       if (Dep.IsIgnorable(P) == true)
 	 continue;
@@ -539,6 +662,7 @@ void pkgDepCache::AddStates(const PkgIterator &Pkg, bool const Invert)
    allows easy detection of the state of a whole or'd group. */
 void pkgDepCache::BuildGroupOrs(VerIterator const &V)
 {
+   RequireFullState();
    unsigned char Group = 0;
    for (DepIterator D = V.DependsList(); D.end() != true; ++D)
    {
@@ -573,6 +697,7 @@ unsigned char pkgDepCache::VersionState(DepIterator D, unsigned char const Check
 				       unsigned char const SetMin,
 				       unsigned char const SetPolicy) const
 {
+   const_cast<pkgDepCache *>(this)->RequireFullState();
    unsigned char Dep = 0xFF;
    while (D.end() != true)
    {
@@ -623,6 +748,7 @@ unsigned char pkgDepCache::DependencyState(DepIterator const &D)
    dependency information. */
 void pkgDepCache::UpdateVerState(PkgIterator const &Pkg)
 {   
+   RequireFullState();
    // Empty deps are always true
    StateCache &State = PkgState[Pkg->ID];
    State.DepState = 0xFF;
@@ -657,6 +783,8 @@ void pkgDepCache::UpdateVerState(PkgIterator const &Pkg)
    dependencies based on the current policy. */
 void pkgDepCache::Update(OpProgress * const Prog)
 {   
+   RequireFullState();
+
    iUsrSize = 0;
    iDownloadSize = 0;
    iInstCount = 0;
@@ -672,27 +800,7 @@ void pkgDepCache::Update(OpProgress * const Prog)
    {
       if (Prog != 0 && Done%20 == 0)
 	 Prog->Progress(Done);
-      for (VerIterator V = I.VersionList(); V.end() != true; ++V)
-      {
-	 unsigned char Group = 0;
-
-	 for (DepIterator D = V.DependsList(); D.end() != true; ++D)
-	 {
-	    // Build the dependency state.
-	    unsigned char &State = DepState[D->ID];
-	    State = DependencyState(D);
-
-	    // Add to the group if we are within an or..
-	    Group |= State;
-	    State |= Group << 3;
-	    if ((D->CompareOp & Dep::Or) != Dep::Or)
-	       Group = 0;
-
-	    // Invert for Conflicts
-	    if (D.IsNegative() == true)
-	       State = ~State;
-	 }
-      }
+      UpdateDepends(I);
 
       // Compute the package dependency state and size additions
       AddSizes(I);
@@ -706,27 +814,45 @@ void pkgDepCache::Update(OpProgress * const Prog)
    readStateFile(Prog);
 }
 									/*}}}*/
+// DepCache::UpdateDepends - Compute the dependency states of a package	/*{{{*/
+// ---------------------------------------------------------------------
+/* The depends pass of Update for the dependencies of all versions of a
+   single package. */
+void pkgDepCache::UpdateDepends(PkgIterator const &Pkg)
+{
+   for (VerIterator V = Pkg.VersionList(); V.end() != true; ++V)
+   {
+      unsigned char Group = 0;
+
+      for (DepIterator D = V.DependsList(); D.end() != true; ++D)
+      {
+	 // Build the dependency state.
+	 unsigned char &State = DepState[D->ID];
+	 State = DependencyState(D);
+
+	 // Add to the group if we are within an or..
+	 Group |= State;
+	 State |= Group << 3;
+	 if ((D->CompareOp & Dep::Or) != Dep::Or)
+	    Group = 0;
+
+	 // Invert for Conflicts
+	 if (D.IsNegative() == true)
+	    State = ~State;
+      }
+   }
+}
+									/*}}}*/
 // DepCache::Update - Update the deps list of a package	   		/*{{{*/
 // ---------------------------------------------------------------------
 /* This is a helper for update that only does the dep portion of the scan. 
    It is mainly meant to scan reverse dependencies. */
 void pkgDepCache::Update(DepIterator D)
 {
+   RequireFullState();
    // Update the reverse deps
    for (;D.end() != true; ++D)
-   {      
-      unsigned char &State = DepState[D->ID];
-      State = DependencyState(D);
-    
-      // Invert for Conflicts
-      if (D.IsNegative() == true)
-	 State = ~State;
-
-      RemoveStates(D.ParentPkg());
-      BuildGroupOrs(D.ParentVer());
-      UpdateVerState(D.ParentPkg());
-      AddStates(D.ParentPkg());
-   }
+      UpdateDepState(D);
 }
 									/*}}}*/
 // DepCache::Update - Update the related deps of a package		/*{{{*/
@@ -735,25 +861,52 @@ void pkgDepCache::Update(DepIterator D)
    all cached dependencies related to this package. */
 void pkgDepCache::Update(PkgIterator const &Pkg)
 {   
+   RequireFullState();
    // Recompute the dep of the package
    RemoveStates(Pkg);
    UpdateVerState(Pkg);
    AddStates(Pkg);
    
    // Update the reverse deps
-   Update(Pkg.RevDependsList());
+   UpdateRevDepends(Pkg);
 
    // Update the provides map for the current ver
    if (Pkg->CurrentVer != 0)
       for (PrvIterator P = Pkg.CurrentVer().ProvidesList(); 
 	   P.end() != true; ++P)
-	 Update(P.ParentPkg().RevDependsList());
+	 UpdateRevDepends(P.ParentPkg());
 
    // Update the provides map for the candidate ver
    if (PkgState[Pkg->ID].CandidateVer != 0)
       for (PrvIterator P = PkgState[Pkg->ID].CandidateVerIter(*this).ProvidesList();
 	   P.end() != true; ++P)
-	 Update(P.ParentPkg().RevDependsList());
+	 UpdateRevDepends(P.ParentPkg());
+}
+									/*}}}*/
+// DepCache::UpdateRevDepends - Update the reverse deps of a package	/*{{{*/
+// ---------------------------------------------------------------------
+/* Like Update(DepIterator) for the reverse dependencies, but reads them
+   from the reverse index of the cache if it has one. */
+void pkgDepCache::UpdateRevDepends(PkgIterator const &Pkg)
+{
+   for (auto const &D : Pkg.RevDependsRange())
+      UpdateDepState(D);
+}
+									/*}}}*/
+// DepCache::UpdateDepState - Recompute a dependency and its parent	/*{{{*/
+void pkgDepCache::UpdateDepState(DepIterator const &D)
+{
+   unsigned char &State = DepState[D->ID];
+   State = DependencyState(D);
+
+   // Invert for Conflicts
+   if (D.IsNegative() == true)
+      State = ~State;
+
+   RemoveStates(D.ParentPkg());
+   BuildGroupOrs(D.ParentVer());
+   UpdateVerState(D.ParentPkg());
+   AddStates(D.ParentPkg());
 }
 									/*}}}*/
 // DepCache::MarkKeep - Put the package in the keep state		/*{{{*/
@@ -762,6 +915,7 @@ void pkgDepCache::Update(PkgIterator const &Pkg)
 bool pkgDepCache::MarkKeep(PkgIterator const &Pkg, bool Soft, bool FromUser,
                            unsigned long Depth)
 {
+   RequireFullState();
    if (IsModeChangeOk(ModeKeep, Pkg, Depth, FromUser) == false)
       return false;
 
@@ -822,6 +976,7 @@ bool pkgDepCache::MarkKeep(PkgIterator const &Pkg, bool Soft, bool FromUser,
 bool pkgDepCache::MarkDelete(PkgIterator const &Pkg, bool rPurge,
                              unsigned long Depth, bool FromUser)
 {
+   RequireFullState();
    if (IsModeChangeOk(ModeDelete, Pkg, Depth, FromUser) == false)
       return false;
 
@@ -1330,6 +1485,7 @@ bool pkgDepCache::MarkInstall(PkgIterator const &Pkg, bool AutoInst,
 			      unsigned long Depth, bool FromUser,
 			      bool ForceImportantDeps)
 {
+   RequireFullState();
    if (IsModeChangeOk(ModeInstall, Pkg, Depth, FromUser) == false)
       return false;
 
@@ -1506,6 +1662,7 @@ bool pkgDepCache::IsInstallOkDependenciesSatisfiableByCandidates(PkgIterator con
    if (AutoInst == false)
       return true;
 
+   RequireFullState();
    VerIterator const CandVer = PkgState[Pkg->ID].CandidateVerIter(*this);
    if (unlikely(CandVer.end() == true) || CandVer == Pkg.CurrentVer())
       return true;
@@ -1559,6 +1716,8 @@ void pkgDepCache::SetReInstall(PkgIterator const &Pkg,bool To)
    if (unlikely(Pkg.end() == true))
       return;
 
+   RequireFullState();
+
    APT::PackageList pkglist;
    if (Pkg->CurrentVer != 0 &&
        (Pkg.CurrentVer()-> MultiArch & pkgCache::Version::Same) == pkgCache::Version::Same)
@@ -1593,6 +1752,7 @@ void pkgDepCache::SetReInstall(PkgIterator const &Pkg,bool To)
 									/*}}}*/
 pkgCache::VerIterator pkgDepCache::GetCandidateVersion(PkgIterator const &Pkg)/*{{{*/
 {
+   UpdateLazyCandidate(Pkg);
    return PkgState[Pkg->ID].CandidateVerIter(*this);
 }
 									/*}}}*/
@@ -1601,6 +1761,7 @@ pkgCache::VerIterator pkgDepCache::GetCandidateVersion(PkgIterator const &Pkg)/*
 /* */
 void pkgDepCache::SetCandidateVersion(VerIterator TargetVer)
 {
+   RequireFullState();
    pkgCache::PkgIterator Pkg = TargetVer.ParentPkg();
    StateCache &P = PkgState[Pkg->ID];
 
@@ -2031,7 +2192,7 @@ void pkgDepCache::MarkPackage(const pkgCache::PkgIterator &Pkg,
 
       // handle the virtual part first
       APT::VersionVector providers;
-      for(auto Prv = T.ProvidesList(); Prv.end() == false; ++Prv)
+      for (auto const &Prv : T.ProvidesRange())
       {
 	 auto PP = Prv.OwnerPkg();
 	 if (IsPkgInBoringState(PP, PkgState))
@@ -2120,6 +2281,7 @@ bool pkgDepCache::Sweep()						/*{{{*/
 // DepCache::MarkAndSweep						/*{{{*/
 bool pkgDepCache::MarkAndSweep(InRootSetFunc &rootFunc)
 {
+   RequireFullState();
    return MarkRequired(rootFunc) && Sweep();
 }
 bool pkgDepCache::MarkAndSweep()
@@ -134,7 +134,11 @@ class APT_PUBLIC pkgDepCache : protected pkgCache::Namespace
                        DepCandPolicy = (1 << 4), DepCandMin = (1 << 5)};
    
    // These flags are used in StateCache::iFlags
-   enum InternalFlags {AutoKept = (1 << 0), Purge = (1 << 1), ReInstall = (1 << 2), Protected = (1 << 3)};
+   enum InternalFlags {AutoKept = (1 << 0), Purge = (1 << 1), ReInstall = (1 << 2), Protected = (1 << 3),
+		       /** candidate of a lazily initialized package not chosen yet */
+		       LazyCandidate = (1 << 14),
+		       /** dependency state of a lazily initialized package not computed yet */
+		       LazyState = (1 << 15)};
       
    enum VersionTypes {NowVersion, InstallVersion, CandidateVersion};
    enum ModeList {ModeDelete = 0, ModeKeep = 1, ModeInstall = 2, ModeGarbage = 3};
@@ -365,9 +369,15 @@ class APT_PUBLIC pkgDepCache : protected pkgCache::Namespace
    inline Policy &GetPolicy() {return *LocalPolicy;};
    
    // Accessors
-   inline StateCache &operator [](PkgIterator const &I) {return PkgState[I->ID];};
-   inline StateCache &operator [](PkgIterator const &I) const {return PkgState[I->ID];};
-   inline unsigned char &operator [](DepIterator const &I) {return DepState[I->ID];};
+   inline StateCache &operator [](PkgIterator const &I)
+   {
+      StateCache &State = PkgState[I->ID];
+      if ((State.iFlags & LazyState) != 0)
+	 UpdateLazyState(I);
+      return State;
+   };
+   inline StateCache &operator [](PkgIterator const &I) const {return (*const_cast<pkgDepCache *>(this))[I];};
+   inline unsigned char &operator [](DepIterator const &I) {RequireFullState(); return DepState[I->ID];};
 
    /** \return A function identifying packages in the root set other
     *  than manually installed packages and essential packages, or \b
@@ -485,15 +495,23 @@ class APT_PUBLIC pkgDepCache : protected pkgCache::Namespace
    bool writeStateFile(OpProgress * const prog, bool const InstalledOnly=true);
    
    // Size queries
-   inline signed long long UsrSize() {return iUsrSize;};
-   inline unsigned long long DebSize() {return iDownloadSize;};
-   inline unsigned long DelCount() {return iDelCount;};
-   inline unsigned long KeepCount() {return iKeepCount;};
-   inline unsigned long InstCount() {return iInstCount;};
-   inline unsigned long BrokenCount() {return iBrokenCount;};
-   inline unsigned long PolicyBrokenCount() {return iPolicyBrokenCount;};
-   inline unsigned long BadCount() {return iBadCount;};
-
+   inline signed long long UsrSize() {RequireFullState(); return iUsrSize;};
+   inline unsigned long long DebSize() {RequireFullState(); return iDownloadSize;};
+   inline unsigned long DelCount() {RequireFullState(); return iDelCount;};
+   inline unsigned long KeepCount() {RequireFullState(); return iKeepCount;};
+   inline unsigned long InstCount() {RequireFullState(); return iInstCount;};
+   inline unsigned long BrokenCount() {RequireFullState(); return iBrokenCount;};
+   inline unsigned long PolicyBrokenCount() {RequireFullState(); return iPolicyBrokenCount;};
+   inline unsigned long BadCount() {RequireFullState(); return iBadCount;};
+
+   /** \brief allocate the states and compute them for all packages
+    *
+    * With APT::Cache::LazyDepCache enabled only the states of the packages
+    * asked for are computed (and remembered) while the full pass over all
+    * packages is deferred until an operation needs all of them like
+    * changing a state or asking for the counters. The Marked and Garbage
+    * fields are only valid after this pass.
+    */
    bool Init(OpProgress * const Prog);
    // Generate all state information
    void Update(OpProgress * const Prog = 0);
@@ -513,8 +531,19 @@ class APT_PUBLIC pkgDepCache : protected pkgCache::Namespace
 	 bool const rPurge, unsigned long const Depth, bool const FromUser);
 
    private:
-   void * const d;
-
+   struct Private;
+   Private * const d;
+
+   // Lazy initialization, see #Init
+   inline void RequireFullState() { if (DepState == nullptr) FinishLazyInit(); };
+   void FinishLazyInit();
+   void UpdateLazyState(PkgIterator const &Pkg);
+   APT_HIDDEN void UpdateLazyCandidate(PkgIterator const &Pkg);
+   APT_HIDDEN bool InitLazy(OpProgress * const Prog);
+   APT_HIDDEN void UpdateDepends(PkgIterator const &Pkg);
+
+   APT_HIDDEN void UpdateRevDepends(PkgIterator const &Pkg);
+   APT_HIDDEN void UpdateDepState(DepIterator const &D);
    APT_HIDDEN bool IsModeChangeOk(ModeList const mode, PkgIterator const &Pkg,
 			unsigned long const Depth, bool const FromUser);
 
@@ -343,11 +343,19 @@ bool PackageManagerFancy::StatusChanged(std::string PackageName,
                                         unsigned int TotalSteps,
                                         std::string HumanReadableAction)
 {
-   if (!PackageManager::StatusChanged(PackageName, StepsDone, TotalSteps,
-          HumanReadableAction))
-      return false;
-
-   return DrawStatusLine();
+   // the status line is redrawn in Pulse, so that many changes
+   // reported in between only cause a single update of the terminal
+   return PackageManager::StatusChanged(PackageName, StepsDone, TotalSteps,
+          HumanReadableAction);
+}
+void PackageManagerFancy::Pulse()
+{
+   if (progress_str.empty())
+      return;
+   int const reporting_steps = _config->FindI("DpkgPM::Reporting-Steps", 1);
+   if (percentage < (last_reported_progress + reporting_steps))
+      return;
+   DrawStatusLine();
 }
 bool PackageManagerFancy::DrawStatusLine()
 {
@@ -368,15 +376,16 @@ bool PackageManagerFancy::DrawStatusLine()
    static std::string restore_bg =  "\033[49m";
    static std::string restore_fg = "\033[39m";
 
-   std::cout << save_cursor
+   // build the complete line first, so that it reaches the terminal in one write
+   std::string line;
+   line.append(save_cursor)
       // move cursor position to last row
-             << "\033[" << std::to_string(size.rows) << ";0f"
-             << set_bg_color
-             << set_fg_color
-             << progress_str
-             << restore_bg
-             << restore_fg;
-   std::flush(std::cout);
+      .append("\033[").append(std::to_string(size.rows)).append(";0f")
+      .append(set_bg_color)
+      .append(set_fg_color)
+      .append(progress_str)
+      .append(restore_bg)
+      .append(restore_fg);
 
    // draw text progress bar
    if (_config->FindB("Dpkg::Progress-Fancy::Progress-Bar", true))
@@ -384,14 +393,14 @@ bool PackageManagerFancy::DrawStatusLine()
       int padding = 4;
       auto const progressbar_size = size.columns - padding - String::DisplayLength(progress_str);
       auto const current_percent = percentage / 100.0f;
-      std::cout << " " 
-                << GetTextProgressStr(current_percent, progressbar_size)
-                << " ";
-      std::flush(std::cout);
+      line.append(" ")
+	 .append(GetTextProgressStr(current_percent, progressbar_size))
+	 .append(" ");
    }
 
    // restore
-   std::cout << restore_cursor;
+   line.append(restore_cursor);
+   std::cout << line;
    std::flush(std::cout);
 
    last_reported_progress = percentage;
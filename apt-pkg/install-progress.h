@@ -146,6 +146,7 @@ namespace Progress {
     virtual ~PackageManagerFancy();
     virtual void Start(int child_pty=-1) APT_OVERRIDE;
     virtual void Stop() APT_OVERRIDE;
+    virtual void Pulse() APT_OVERRIDE;
     virtual bool StatusChanged(std::string PackageName,
                                unsigned int StepsDone,
                                unsigned int TotalSteps,
@@ -40,11 +40,16 @@ using namespace std;
 
 bool pkgPackageManager::SigINTStop = false;
 
+struct pkgPackageManager::Private
+{
+   bool WaitForMissing = false;
+};
+
 // PM::PackageManager - Constructor					/*{{{*/
 // ---------------------------------------------------------------------
 /* */
 pkgPackageManager::pkgPackageManager(pkgDepCache *pCache) : Cache(*pCache),
-							    List(NULL), Res(Incomplete), d(NULL)
+							    List(NULL), Res(Incomplete), d(new Private())
 {
    FileNames = new string[Cache.Head().PackageCount];
    Debug = _config->FindB("Debug::pkgPackageManager",false);
@@ -59,6 +64,16 @@ pkgPackageManager::~pkgPackageManager()
 {
    delete List;
    delete [] FileNames;
+   delete d;
+}
+									/*}}}*/
+void pkgPackageManager::SetWaitForMissing(bool const Wait)		/*{{{*/
+{
+   d->WaitForMissing = Wait;
+}
+bool pkgPackageManager::IsWaitingForMissing() const
+{
+   return d->WaitForMissing;
 }
 									/*}}}*/
 // PM::GetArchives - Queue the archives for download			/*{{{*/
@@ -1069,6 +1084,10 @@ pkgPackageManager::OrderResult pkgPackageManager::OrderInstall()
 	    clog << "Sequence completed at " << Pkg.FullName() << endl;
 	 if (DoneSomething == false)
 	 {
+	    /* The archives we need first are still on their way, the caller
+	       will try again once more of them are available */
+	    if (d->WaitForMissing == true)
+	       return Incomplete;
 	    _error->Error("Internal Error, ordering was unable to handle the media swap");
 	    return Failed;
 	 }	 
@@ -124,11 +124,20 @@ class APT_PUBLIC pkgPackageManager : protected pkgCache::Namespace
    /** \brief returns all packages dpkg let disappear */
    inline std::set<std::string> GetDisappearedPackages() { return disappearedPkgs; };
 
+   /** \brief archives missing at the start are a reason to wait, not an error
+    *
+    * Used while the archives are still downloading: DoInstall returns
+    * Incomplete without doing anything if the first package to handle
+    * has no archive yet instead of failing. */
+   void SetWaitForMissing(bool const Wait);
+   bool IsWaitingForMissing() const;
+
    explicit pkgPackageManager(pkgDepCache *Cache);
    virtual ~pkgPackageManager();
 
    private:
-   void * const d;
+   struct Private;
+   Private * const d;
    enum APT_HIDDEN SmartAction { UNPACK_IMMEDIATE, UNPACK, CONFIGURE };
    APT_HIDDEN bool NonLoopingSmart(SmartAction const action, pkgCache::PkgIterator &Pkg,
       pkgCache::PkgIterator DepPkg, int const Depth, bool const PkgLoop,
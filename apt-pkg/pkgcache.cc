@@ -57,8 +57,8 @@ pkgCache::Header::Header()
 
    /* Whenever the structures change the major version should be bumped,
       whenever the generator changes the minor version should be bumped. */
-   APT_HEADER_SET(MajorVersion, 16);
-   APT_HEADER_SET(MinorVersion, 0);
+   APT_HEADER_SET(MajorVersion, 17);
+   APT_HEADER_SET(MinorVersion, 1);
    APT_HEADER_SET(Dirty, false);
 
    APT_HEADER_SET(HeaderSz, sizeof(pkgCache::Header));
@@ -67,6 +67,7 @@ pkgCache::Header::Header()
    APT_HEADER_SET(ReleaseFileSz, sizeof(pkgCache::ReleaseFile));
    APT_HEADER_SET(PackageFileSz, sizeof(pkgCache::PackageFile));
    APT_HEADER_SET(VersionSz, sizeof(pkgCache::Version));
+   APT_HEADER_SET(VersionExtraSz, sizeof(pkgCache::VersionExtra));
    APT_HEADER_SET(DescriptionSz, sizeof(pkgCache::Description));
    APT_HEADER_SET(DependencySz, sizeof(pkgCache::Dependency));
    APT_HEADER_SET(DependencyDataSz, sizeof(pkgCache::DependencyData));
@@ -95,6 +96,18 @@ pkgCache::Header::Header()
    Architecture = 0;
    SetArchitectures(0);
    SetHashTableSize(_config->FindI("APT::Cache-HashTableSize", 50503));
+   GrpSortedList = 0;
+   GrpSortedCount = 0;
+   FieldValueList = 0;
+   FieldValueCount = 0;
+   RevDependsOffset = 0;
+   RevDependsIndex = 0;
+   ProvidesOffset = 0;
+   ProvidesIndex = 0;
+   ReverseIndexCount = 0;
+   StringIndex = 0;
+   MixedStringCount = 0;
+   SectionStringCount = 0;
    memset(Pools,0,sizeof(Pools));
 
    CacheFileSize = 0;
@@ -111,6 +124,7 @@ bool pkgCache::Header::CheckSizes(Header &Against) const
        ReleaseFileSz == Against.ReleaseFileSz &&
        PackageFileSz == Against.PackageFileSz &&
        VersionSz == Against.VersionSz &&
+       VersionExtraSz == Against.VersionExtraSz &&
        DescriptionSz == Against.DescriptionSz &&
        DependencySz == Against.DependencySz &&
        DependencyDataSz == Against.DependencyDataSz &&
@@ -149,6 +163,7 @@ bool pkgCache::ReMap(bool const &Errorchecks)
    RlsFileP = (ReleaseFile *)Map.Data();
    PkgFileP = (PackageFile *)Map.Data();
    VerP = (Version *)Map.Data();
+   VerExtraP = (VersionExtra *)Map.Data();
    DescP = (Description *)Map.Data();
    ProvideP = (Provides *)Map.Data();
    DepP = (Dependency *)Map.Data();
@@ -174,6 +189,26 @@ bool pkgCache::ReMap(bool const &Errorchecks)
 
    if (HeaderP->VerSysName == 0 || HeaderP->Architecture == 0 || HeaderP->GetArchitectures() == 0)
       return _error->Error(_("The package cache file is corrupted"));
+   // the source cache doesn't store the sorted groups as it is extended anyhow
+   if (HeaderP->GrpSortedCount != (HeaderP->GrpSortedList == 0 ? 0 : HeaderP->GroupCount) ||
+       (uint64_t(uint32_t(HeaderP->GrpSortedList)) + HeaderP->GrpSortedCount) * sizeof(map_pointer<Group>) > Map.Size())
+      return _error->Error(_("The package cache file is corrupted"));
+   if ((uint64_t(uint32_t(HeaderP->FieldValueList)) + HeaderP->FieldValueCount) * sizeof(FieldValue) > Map.Size())
+      return _error->Error(_("The package cache file is corrupted"));
+   if ((uint64_t(uint32_t(HeaderP->StringIndex)) + HeaderP->MixedStringCount + HeaderP->SectionStringCount) * sizeof(map_stringitem_t) > Map.Size())
+      return _error->Error(_("The package cache file is corrupted"));
+   if (HeaderP->RevDependsOffset != 0 || HeaderP->ProvidesOffset != 0)
+   {
+      auto const IndexFits = [&](map_pointer<map_id_t> Offsets, uint32_t const Index) {
+	 if ((uint64_t(uint32_t(Offsets)) + HeaderP->ReverseIndexCount + 1) * sizeof(map_id_t) > Map.Size())
+	    return false;
+	 map_id_t const Count = reinterpret_cast<map_id_t const *>(HeaderP)[uint32_t(Offsets) + HeaderP->ReverseIndexCount];
+	 return (uint64_t(Index) + Count) * sizeof(map_id_t) <= Map.Size();
+      };
+      if (IndexFits(HeaderP->RevDependsOffset, uint32_t(HeaderP->RevDependsIndex)) == false ||
+	  IndexFits(HeaderP->ProvidesOffset, uint32_t(HeaderP->ProvidesIndex)) == false)
+	 return _error->Error(_("The package cache file is corrupted"));
+   }
 
    // Locate our VS..
    if ((VS = pkgVersioningSystem::GetVS(StrP + HeaderP->VerSysName)) == 0)
@@ -341,6 +376,80 @@ pkgCache::GrpIterator pkgCache::FindGrp(StringView Name) {
 	return GrpIterator(*this,0);
 }
 									/*}}}*/
+// Cache::FindGrpPrefix - Locate groups by the start of their name	/*{{{*/
+// ---------------------------------------------------------------------
+/* The sorted list is ordered by stringcasecmp, so comparing the names cut
+   to the length of the prefix splits it into three consecutive parts */
+std::pair<map_pointer<pkgCache::Group> const *, map_pointer<pkgCache::Group> const *>
+pkgCache::FindGrpPrefix(StringView Prefix) const
+{
+   auto const Begin = reinterpret_cast<map_pointer<Group> const *>(HeaderP) + uint32_t(HeaderP->GrpSortedList);
+   auto const End = Begin + HeaderP->GrpSortedCount;
+   if (Prefix.empty() == true)
+      return {Begin, End};
+
+   auto const ComparePrefix = [&](map_pointer<Group> G) {
+      char const * const Name = StrP + (GrpP + G)->Name;
+      size_t const Len = strnlen(Name, Prefix.length());
+      return stringcasecmp(Name, Name + Len, Prefix.begin(), Prefix.end());
+   };
+   auto const First = std::partition_point(Begin, End, [&](map_pointer<Group> G) { return ComparePrefix(G) < 0; });
+   auto const Last = std::partition_point(First, End, [&](map_pointer<Group> G) { return ComparePrefix(G) == 0; });
+   return {First, Last};
+}
+									/*}}}*/
+// Cache::FindFieldValues - Locate the index entries of a field	/*{{{*/
+std::pair<pkgCache::FieldValue const *, pkgCache::FieldValue const *>
+pkgCache::FindFieldValues(StringView Field) const
+{
+   auto const Begin = reinterpret_cast<FieldValue const *>(HeaderP) + uint32_t(HeaderP->FieldValueList);
+   auto const End = Begin + HeaderP->FieldValueCount;
+   struct CompareField
+   {
+      pkgCache const *Cache;
+      bool operator()(FieldValue const &A, StringView const B) const { return Cache->ViewString(A.Field).compare(B) < 0; }
+      bool operator()(StringView const A, FieldValue const &B) const { return A.compare(Cache->ViewString(B.Field)) < 0; }
+   };
+   return std::equal_range(Begin, End, Field, CompareField{this});
+}
+									/*}}}*/
+// Cache::HasReverseIndex - Check if the reverse index is usable	/*{{{*/
+// ---------------------------------------------------------------------
+/* Each dependency is in the reverse list of exactly one package and each
+   provides likewise, so the index covers all of them if it has as many
+   entries as the cache has dependencies and provides. */
+bool pkgCache::HasReverseIndex() const
+{
+   if (HeaderP->RevDependsOffset == 0 || HeaderP->ProvidesOffset == 0 ||
+	 HeaderP->ReverseIndexCount != HeaderP->PackageCount)
+      return false;
+   auto const Offsets = reinterpret_cast<map_id_t const *>(HeaderP);
+   return Offsets[uint32_t(HeaderP->RevDependsOffset) + HeaderP->PackageCount] == HeaderP->DependsCount &&
+      Offsets[uint32_t(HeaderP->ProvidesOffset) + HeaderP->PackageCount] == HeaderP->ProvidesCount;
+}
+									/*}}}*/
+// Cache::RevDependsIndex - Locate the reverse depends of a package	/*{{{*/
+std::pair<map_pointer<pkgCache::Dependency> const *, map_pointer<pkgCache::Dependency> const *>
+pkgCache::RevDependsIndex(Package const *Pkg) const
+{
+   if (HasReverseIndex() == false)
+      return {nullptr, nullptr};
+   auto const Offsets = reinterpret_cast<map_id_t const *>(HeaderP) + uint32_t(HeaderP->RevDependsOffset);
+   auto const Index = reinterpret_cast<map_pointer<Dependency> const *>(HeaderP) + uint32_t(HeaderP->RevDependsIndex);
+   return {Index + Offsets[Pkg->ID], Index + Offsets[Pkg->ID + 1]};
+}
+									/*}}}*/
+// Cache::ProvidesIndex - Locate the provides of a package		/*{{{*/
+std::pair<map_pointer<pkgCache::Provides> const *, map_pointer<pkgCache::Provides> const *>
+pkgCache::ProvidesIndex(Package const *Pkg) const
+{
+   if (HasReverseIndex() == false)
+      return {nullptr, nullptr};
+   auto const Offsets = reinterpret_cast<map_id_t const *>(HeaderP) + uint32_t(HeaderP->ProvidesOffset);
+   auto const Index = reinterpret_cast<map_pointer<Provides> const *>(HeaderP) + uint32_t(HeaderP->ProvidesIndex);
+   return {Index + Offsets[Pkg->ID], Index + Offsets[Pkg->ID + 1]};
+}
+									/*}}}*/
 // Cache::CompTypeDeb - Return a string describing the compare type	/*{{{*/
 // ---------------------------------------------------------------------
 /* This returns a string representation of the dependency compare 
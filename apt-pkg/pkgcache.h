@@ -79,6 +79,7 @@
 
 #include <cstddef>       // required for nullptr_t
 #include <string>
+#include <utility>
 #include <stdint.h>
 #include <time.h>
 
@@ -114,7 +115,10 @@ template<typename T> inline uint32_t operator -(map_pointer<T> u, map_pointer<T>
 template<typename T> bool operator ==(map_pointer<T> m, std::nullptr_t) { return uint32_t(m) == 0; }
 template<typename T> bool operator !=(map_pointer<T> m, std::nullptr_t) { return uint32_t(m) != 0; }
 
-// same as the previous, but documented to be to a string item
+// same as the previous, but documented to be to a string item.
+// Architectures, sections, archives, origins, labels, components and
+// languages are stored only once, so within a cache equal strings of
+// these kinds have equal offsets and can be compared by them.
 typedef map_pointer<char> map_stringitem_t;
 
 // we have only a small amount of flags for each item
@@ -132,6 +136,7 @@ class APT_PUBLIC pkgCache								/*{{{*/
    struct ReleaseFile;
    struct PackageFile;
    struct Version;
+   struct VersionExtra;
    struct Description;
    struct Provides;
    struct Dependency;
@@ -139,6 +144,7 @@ class APT_PUBLIC pkgCache								/*{{{*/
    struct StringItem;
    struct VerFile;
    struct DescFile;
+   struct FieldValue;
    
    // Iterators
    template<typename Str, typename Itr> class Iterator;
@@ -152,6 +158,7 @@ class APT_PUBLIC pkgCache								/*{{{*/
    class PkgFileIterator;
    class VerFileIterator;
    class DescFileIterator;
+   template<typename Str, typename Itr> class ReverseList;
    
    class Namespace;
    
@@ -231,7 +238,8 @@ class APT_PUBLIC pkgCache								/*{{{*/
    Dependency *DepP;
    DependencyData *DepDataP;
    char *StrP;
-   void *reserved[12];
+   VersionExtra *VerExtraP;
+   void *reserved[11];
 
    virtual bool ReMap(bool const &Errorchecks = true);
    inline bool Sync() {return Map.Sync();}
@@ -248,6 +256,21 @@ class APT_PUBLIC pkgCache								/*{{{*/
    
    // Accessors
    GrpIterator FindGrp(APT::StringView Name);
+   /** \brief range of groups whose name starts with Prefix, sorted by name
+
+       Names are compared ignoring (ASCII) case, so callers needing an exact
+       prefix match still have to check each group in the range. */
+   std::pair<map_pointer<Group> const *, map_pointer<Group> const *> FindGrpPrefix(APT::StringView Prefix) const;
+   /** \brief range of the indexed values of a field like Task, sorted by value */
+   std::pair<FieldValue const *, FieldValue const *> FindFieldValues(APT::StringView Field) const;
+   /** \brief if the reverse index covers all packages, dependencies and provides */
+   bool HasReverseIndex() const APT_PURE;
+   /** \brief range of the reverse dependencies of a package in the reverse index
+
+       Both pointers are null if the cache has no (current) reverse index. */
+   std::pair<map_pointer<Dependency> const *, map_pointer<Dependency> const *> RevDependsIndex(Package const *Pkg) const APT_PURE;
+   /** \brief range of the provides of a package in the reverse index */
+   std::pair<map_pointer<Provides> const *, map_pointer<Provides> const *> ProvidesIndex(Package const *Pkg) const APT_PURE;
    PkgIterator FindPkg(APT::StringView Name);
    PkgIterator FindPkg(APT::StringView Name, APT::StringView Arch);
 
@@ -319,6 +342,7 @@ struct pkgCache::Header
    map_number_t ReleaseFileSz;
    map_number_t PackageFileSz;
    map_number_t VersionSz;
+   map_number_t VersionExtraSz;
    map_number_t DescriptionSz;
    map_number_t DependencySz;
    map_number_t DependencyDataSz;
@@ -393,6 +417,46 @@ struct pkgCache::Header
    map_pointer<Package> * PkgHashTableP() const { return reinterpret_cast<map_pointer<Package> *>(GrpHashTableP() + GetHashTableSize()); }
 #endif
 
+   /** \brief groups sorted by name
+
+       An array of GrpSortedCount pointers to all groups sorted by their
+       name ignoring (ASCII) case, so that prefix searches for completion
+       and pattern selection do not have to look at each group.
+       The source cache is stored without it. */
+   map_pointer<map_pointer<Group>> GrpSortedList;
+   map_id_t GrpSortedCount;
+
+   /** \brief index of multi-valued fields like Task
+
+       An array of FieldValueCount entries sorted by field and value, so the
+       versions belonging to a task can be found without parsing records. */
+   map_pointer<FieldValue> FieldValueList;
+   map_id_t FieldValueCount;
+
+   /** \brief reverse dependencies and provides as contiguous arrays
+
+       The entries RevDependsOffset[ID] up to RevDependsOffset[ID + 1] of
+       RevDependsIndex are the reverse dependencies of the package with
+       this ID in the order of the list starting at Package::RevDepends,
+       and likewise for the provides. The offset arrays have one entry more
+       than the ReverseIndexCount packages they were created for.
+       The source cache is stored without them. */
+   map_pointer<map_id_t> RevDependsOffset;
+   map_pointer<map_pointer<Dependency>> RevDependsIndex;
+   map_pointer<map_id_t> ProvidesOffset;
+   map_pointer<map_pointer<Provides>> ProvidesIndex;
+   map_id_t ReverseIndexCount;
+
+   /** \brief the deduplicated strings which are not version numbers
+
+       An array of the offsets of the MixedStringCount architectures,
+       archives, origins, … followed by the SectionStringCount sections, so
+       that extending the cache can continue the deduplication without a
+       look at each package and version. */
+   map_pointer<map_stringitem_t> StringIndex;
+   map_id_t MixedStringCount;
+   map_id_t SectionStringCount;
+
    /** \brief Hash of the file (TODO: Rename) */
    map_filesize_small_t CacheFileSize;
 
@@ -620,19 +684,16 @@ struct pkgCache::DescFile
 
     The version list is always sorted from highest version to lowest
     version by the generator. Equal version numbers are either merged
-    or handled as separate versions based on the Hash value. */
+    or handled as separate versions based on the Hash value.
+
+    Only the data needed to order versions and to resolve dependencies is
+    stored here, so these records are small and densely packed; everything
+    else is in a pkgCache::VersionExtra record. VerIterator provides access
+    to the fields of both as if they were one structure. */
 struct pkgCache::Version
 {
    /** \brief complete version string */
    map_stringitem_t VerStr;
-   /** \brief section this version is filled in */
-   map_stringitem_t Section;
-   /** \brief source package name this version comes from
-      Always contains the name, even if it is the same as the binary name */
-   map_stringitem_t SourcePkgName;
-   /** \brief source version this version comes from
-      Always contains the version string, even if it is the same as the binary version */
-   map_stringitem_t SourceVerStr;
 
    /** \brief Multi-Arch capabilities of a package version */
    enum VerMultiArch { No = 0, /*!< is the default and doesn't trigger special behaviour */
@@ -648,6 +709,8 @@ struct pkgCache::Version
        Flags used are defined in pkgCache::Version::VerMultiArch
    */
    map_number_t MultiArch;
+   /** \brief parsed priority value */
+   map_number_t Priority;
 
    /** \brief references all the PackageFile's that this version came from
 
@@ -658,8 +721,6 @@ struct pkgCache::Version
    map_pointer<VerFile> FileList;
    /** \brief next (lower or equal) version in the linked list */
    map_pointer<Version> NextVer;
-   /** \brief next description in the linked list */
-   map_pointer<Description> DescriptionList;
    /** \brief base of the dependency list */
    map_pointer<Dependency> DependsList;
    /** \brief links to the owning package
@@ -668,25 +729,45 @@ struct pkgCache::Version
    map_pointer<Package> ParentPkg;
    /** \brief list of pkgCache::Provides */
    map_pointer<Provides> ProvidesList;
+   /** \brief the less often used data of this version */
+   map_pointer<VersionExtra> Extra;
 
-   /** \brief archive size for this version
+   /** \brief unique sequel ID */
+   map_id_t ID;
+};
+									/*}}}*/
+// VersionExtra structure						/*{{{*/
+/** \brief the data of a version which is not needed for resolving
 
-       For Debian this is the size of the .deb file. */
-   map_filesize_t Size; // These are the .deb size
-   /** \brief uncompressed size for this version */
-   map_filesize_t InstalledSize;
+    Each pkgCache::Version has exactly one of these records, which is
+    allocated together with it but in a pool of its own. */
+struct pkgCache::VersionExtra
+{
+   /** \brief section this version is filled in */
+   map_stringitem_t Section;
+   /** \brief source package name this version comes from
+      Always contains the name, even if it is the same as the binary name */
+   map_stringitem_t SourcePkgName;
+   /** \brief source version this version comes from
+      Always contains the version string, even if it is the same as the binary version */
+   map_stringitem_t SourceVerStr;
+   /** \brief next description in the linked list */
+   map_pointer<Description> DescriptionList;
    /** \brief characteristic value representing this version
 
        No two packages in existence should have the same VerStr
        and Hash with different contents. */
    uint32_t Hash;
-   /** \brief unique sequel ID */
-   map_id_t ID;
-   /** \brief parsed priority value */
-   map_number_t Priority;
    /** \brief next version in the source package (might be different binary) */
    map_pointer<Version> NextInSource;
 
+   /** \brief archive size for this version
+
+       For Debian this is the size of the .deb file. */
+   map_filesize_t Size; // These are the .deb size
+   /** \brief uncompressed size for this version */
+   map_filesize_t InstalledSize;
+
    /** \brief Private pointer */
    map_pointer<void> d;
 };
@@ -784,6 +865,22 @@ struct pkgCache::Provides
    map_pointer<Provides> NextPkgProv;
 };
 									/*}}}*/
+// FieldValue structure							/*{{{*/
+/** \brief one value of an indexed multi-valued field of a version
+
+    Records list e.g. the tasks a package belongs to in a comma-separated
+    field. The generator splits such fields and stores an entry for each
+    value, so selecting packages by them is a lookup in a sorted array. */
+struct pkgCache::FieldValue
+{
+   /** \brief name of the field, e.g. Task */
+   map_stringitem_t Field;
+   /** \brief one of the values the field has */
+   map_stringitem_t Value;
+   /** \brief version whose record contains this value */
+   map_pointer<pkgCache::Version> Version;
+};
+									/*}}}*/
 
 inline char const * pkgCache::NativeArch()
 	{ return StrP + HeaderP->Architecture; }
@@ -11,9 +11,11 @@
 // Include Files							/*{{{*/
 #include <config.h>
 
+#include <apt-pkg/aptconfiguration.h>
 #include <apt-pkg/configuration.h>
 #include <apt-pkg/error.h>
 #include <apt-pkg/fileutl.h>
+#include <apt-pkg/hashes.h>
 #include <apt-pkg/indexfile.h>
 #include <apt-pkg/macros.h>
 #include <apt-pkg/metaindex.h>
@@ -23,6 +25,7 @@
 #include <apt-pkg/pkgsystem.h>
 #include <apt-pkg/progress.h>
 #include <apt-pkg/sourcelist.h>
+#include <apt-pkg/strutl.h>
 #include <apt-pkg/version.h>
 
 #include <algorithm>
@@ -47,6 +50,8 @@ static bool IsDuplicateDescription(pkgCache &Cache, pkgCache::DescIterator Desc,
 using std::string;
 using APT::StringView;
 
+static Configuration::Key const DebugCacheGen("Debug::pkgCacheGen");
+
 // Convert an offset returned from e.g. DynamicMMap or ptr difference to
 // an uint32_t location without data loss.
 template <typename T>
@@ -67,6 +72,7 @@ pkgCacheGenerator::pkgCacheGenerator(DynamicMMap *pMap,OpProgress *Prog) :
 		    Map(*pMap), Cache(pMap,false), Progress(Prog),
 		     CurrentRlsFile(nullptr), CurrentFile(nullptr), d(nullptr)
 {
+   DependsTargets.resize(1024);
 }
 bool pkgCacheGenerator::Start()
 {
@@ -130,6 +136,7 @@ bool pkgCacheGenerator::Start()
       Map.UsePools(*Cache.HeaderP->Pools,sizeof(Cache.HeaderP->Pools)/sizeof(Cache.HeaderP->Pools[0]));
       if (Cache.VS != _system->VS)
 	 return _error->Error(_("Cache has an incompatible versioning system"));
+      LoadStrings();
    }
 
    Cache.HeaderP->Dirty = true;
@@ -145,13 +152,13 @@ pkgCacheGenerator::~pkgCacheGenerator()
 {
    if (_error->PendingError() == true || Map.validData() == false)
       return;
-   if (Map.Sync() == false)
+   if (BuildIndexes() == false || Map.Sync() == false)
       return;
    
    Cache.HeaderP->Dirty = false;
    Cache.HeaderP->CacheFileSize = Cache.CacheHash();
 
-   if (_config->FindB("Debug::pkgCacheGen", false))
+   if (_config->FindB(DebugCacheGen, false))
       std::clog << "Produced cache with hash " << Cache.HeaderP->CacheFileSize << std::endl;
    Map.Sync(0,sizeof(pkgCache::Header));
 }
@@ -164,7 +171,7 @@ void pkgCacheGenerator::ReMap(void const * const oldMap, void const * const newM
    if (oldMap == newMap)
       return;
 
-   if (_config->FindB("Debug::pkgCacheGen", false))
+   if (_config->FindB(DebugCacheGen, false))
       std::clog << "Remapping from " << oldMap << " to " << newMap << std::endl;
 
    Cache.ReMap(false);
@@ -238,6 +245,202 @@ map_stringitem_t pkgCacheGenerator::WriteStringInMap(const char *String) {
    return index;
 }
 									/*}}}*/
+// CacheGenerator::SortGroups - Create the sorted list of groups	/*{{{*/
+// ---------------------------------------------------------------------
+/* The list is only valid for the groups which existed when it was created,
+   so each time groups were added a new one is created in the map. */
+bool pkgCacheGenerator::SortGroups()
+{
+   map_id_t const Count = Cache.HeaderP->GroupCount;
+   if (Cache.HeaderP->GrpSortedList != 0 && Cache.HeaderP->GrpSortedCount == Count)
+      return true;
+
+   std::vector<map_pointer<pkgCache::Group>> Sorted;
+   Sorted.reserve(Count);
+   for (auto Grp = Cache.GrpBegin(); Grp.end() == false; ++Grp)
+      Sorted.push_back(Grp.MapPointer());
+   if (unlikely(Sorted.size() != Count))
+      return _error->Error("Internal error: found %zu groups in the cache, but expected %u", Sorted.size(), Count);
+
+   std::sort(Sorted.begin(), Sorted.end(), [&](map_pointer<pkgCache::Group> A, map_pointer<pkgCache::Group> B) {
+      auto const NameA = Cache.ViewString((Cache.GrpP + A)->Name);
+      auto const NameB = Cache.ViewString((Cache.GrpP + B)->Name);
+      int const Res = stringcasecmp(NameA.begin(), NameA.end(), NameB.begin(), NameB.end());
+      if (Res != 0)
+	 return Res < 0;
+      return NameA.compare(NameB) < 0;
+   });
+
+   size_t oldSize = Map.Size();
+   void const * const oldMap = Map.Data();
+   size_t const Size = Sorted.size() * sizeof(Sorted[0]);
+   auto const Offset = Map.RawAllocate(Size, sizeof(Sorted[0]));
+   if (unlikely(Offset == 0))
+      return false;
+   ReMap(oldMap, Map.Data(), oldSize);
+   if (Size != 0)
+      memcpy(static_cast<char *>(Map.Data()) + Offset, Sorted.data(), Size);
+   Cache.HeaderP->GrpSortedList = map_pointer<map_pointer<pkgCache::Group>>(Offset / sizeof(Sorted[0]));
+   Cache.HeaderP->GrpSortedCount = Count;
+   return true;
+}
+									/*}}}*/
+// CacheGenerator::SortFieldValues - Merge new values into the index	/*{{{*/
+// ---------------------------------------------------------------------
+/* Like the sorted groups the index is recreated with the old and the new
+   entries whenever values were added, so it is always one sorted array. */
+bool pkgCacheGenerator::SortFieldValues()
+{
+   if (NewFieldValues.empty() == true && Cache.HeaderP->FieldValueList != 0)
+      return true;
+
+   std::vector<pkgCache::FieldValue> Sorted;
+   Sorted.reserve(Cache.HeaderP->FieldValueCount + NewFieldValues.size());
+   auto const OldBegin = reinterpret_cast<pkgCache::FieldValue const *>(Cache.HeaderP) + uint32_t(Cache.HeaderP->FieldValueList);
+   Sorted.insert(Sorted.end(), OldBegin, OldBegin + Cache.HeaderP->FieldValueCount);
+   Sorted.insert(Sorted.end(), NewFieldValues.begin(), NewFieldValues.end());
+
+   std::sort(Sorted.begin(), Sorted.end(), [&](pkgCache::FieldValue const &A, pkgCache::FieldValue const &B) {
+      if (A.Field != B.Field)
+      {
+	 int const Res = Cache.ViewString(A.Field).compare(Cache.ViewString(B.Field));
+	 if (Res != 0)
+	    return Res < 0;
+      }
+      if (A.Value != B.Value)
+	 return Cache.ViewString(A.Value).compare(Cache.ViewString(B.Value)) < 0;
+      return A.Version < B.Version;
+   });
+
+   size_t oldSize = Map.Size();
+   void const * const oldMap = Map.Data();
+   size_t const Size = Sorted.size() * sizeof(Sorted[0]);
+   auto const Offset = Map.RawAllocate(Size, sizeof(Sorted[0]));
+   if (unlikely(Offset == 0))
+      return false;
+   ReMap(oldMap, Map.Data(), oldSize);
+   if (Size != 0)
+      memcpy(static_cast<char *>(Map.Data()) + Offset, Sorted.data(), Size);
+   Cache.HeaderP->FieldValueList = map_pointer<pkgCache::FieldValue>(Offset / sizeof(Sorted[0]));
+   Cache.HeaderP->FieldValueCount = Sorted.size();
+   NewFieldValues.clear();
+   return true;
+}
+									/*}}}*/
+// CacheGenerator::BuildReverseIndex - Store reverse lists as arrays	/*{{{*/
+// ---------------------------------------------------------------------
+/* The linked lists stay the canonical representation; the index is a copy
+   of them in package ID order, so it is recreated whenever dependencies or
+   provides were added to the cache. */
+bool pkgCacheGenerator::BuildReverseIndex()
+{
+   if (_config->FindB("APT::Cache-ReverseIndex", true) == false)
+   {
+      Cache.HeaderP->RevDependsOffset = 0;
+      Cache.HeaderP->ProvidesOffset = 0;
+      return true;
+   }
+   if (Cache.HasReverseIndex() == true)
+      return true;
+
+   map_id_t const Count = Cache.HeaderP->PackageCount;
+   std::vector<map_pointer<pkgCache::Package>> Packages(Count);
+   for (auto Pkg = Cache.PkgBegin(); Pkg.end() == false; ++Pkg)
+      Packages[Pkg->ID] = Pkg.MapPointer();
+
+   std::vector<map_id_t> DepOffsets, PrvOffsets;
+   DepOffsets.reserve(Count + 1);
+   PrvOffsets.reserve(Count + 1);
+   std::vector<map_pointer<pkgCache::Dependency>> Deps;
+   std::vector<map_pointer<pkgCache::Provides>> Prvs;
+   Deps.reserve(Cache.HeaderP->DependsCount);
+   Prvs.reserve(Cache.HeaderP->ProvidesCount);
+   for (auto const P : Packages)
+   {
+      pkgCache::PkgIterator const Pkg(Cache, Cache.PkgP + P);
+      DepOffsets.push_back(Deps.size());
+      for (auto D = Pkg.RevDependsList(); D.end() == false; ++D)
+	 Deps.push_back(D.MapPointer());
+      PrvOffsets.push_back(Prvs.size());
+      for (auto Prv = Pkg.ProvidesList(); Prv.end() == false; ++Prv)
+	 Prvs.push_back(Prv.MapPointer());
+   }
+   DepOffsets.push_back(Deps.size());
+   PrvOffsets.push_back(Prvs.size());
+   if (unlikely(Deps.size() != Cache.HeaderP->DependsCount || Prvs.size() != Cache.HeaderP->ProvidesCount))
+      return _error->Error("Internal error: found %zu dependencies and %zu provides in the cache, but expected %u and %u",
+	    Deps.size(), Prvs.size(), Cache.HeaderP->DependsCount, Cache.HeaderP->ProvidesCount);
+
+   auto const Store = [&](void const * const Data, size_t const Items) -> uint32_t {
+      size_t oldSize = Map.Size();
+      void const * const oldMap = Map.Data();
+      size_t const Size = Items * sizeof(map_id_t);
+      auto const Offset = Map.RawAllocate(Size, sizeof(map_id_t));
+      if (unlikely(Offset == 0))
+	 return 0;
+      ReMap(oldMap, Map.Data(), oldSize);
+      if (Size != 0)
+	 memcpy(static_cast<char *>(Map.Data()) + Offset, Data, Size);
+      return Offset / sizeof(map_id_t);
+   };
+   static_assert(sizeof(map_pointer<pkgCache::Dependency>) == sizeof(map_id_t), "index entries have the size of an offset");
+   auto const DepOffset = Store(DepOffsets.data(), DepOffsets.size());
+   auto const DepIndex = Store(Deps.data(), Deps.size());
+   auto const PrvOffset = Store(PrvOffsets.data(), PrvOffsets.size());
+   auto const PrvIndex = Store(Prvs.data(), Prvs.size());
+   if (unlikely(DepOffset == 0 || DepIndex == 0 || PrvOffset == 0 || PrvIndex == 0))
+      return false;
+   Cache.HeaderP->RevDependsOffset = map_pointer<map_id_t>(DepOffset);
+   Cache.HeaderP->RevDependsIndex = map_pointer<map_pointer<pkgCache::Dependency>>(DepIndex);
+   Cache.HeaderP->ProvidesOffset = map_pointer<map_id_t>(PrvOffset);
+   Cache.HeaderP->ProvidesIndex = map_pointer<map_pointer<pkgCache::Provides>>(PrvIndex);
+   Cache.HeaderP->ReverseIndexCount = Count;
+   return true;
+}
+									/*}}}*/
+// CacheGenerator::StoreStringIndex - Remember the deduplicated strings	/*{{{*/
+bool pkgCacheGenerator::StoreStringIndex()
+{
+   if (Cache.HeaderP->StringIndex != 0 &&
+       Cache.HeaderP->MixedStringCount == strMixed.size() &&
+       Cache.HeaderP->SectionStringCount == strSections.size())
+      return true;
+
+   std::vector<map_stringitem_t> Index;
+   Index.reserve(strMixed.size() + strSections.size());
+   for (auto const &S : strMixed)
+      Index.push_back(S.item);
+   for (auto const &S : strSections)
+      Index.push_back(S.item);
+
+   size_t oldSize = Map.Size();
+   void const * const oldMap = Map.Data();
+   size_t const Size = Index.size() * sizeof(Index[0]);
+   auto const Offset = Map.RawAllocate(Size, sizeof(Index[0]));
+   if (unlikely(Offset == 0))
+      return false;
+   ReMap(oldMap, Map.Data(), oldSize);
+   if (Size != 0)
+      memcpy(static_cast<char *>(Map.Data()) + Offset, Index.data(), Size);
+   Cache.HeaderP->StringIndex = map_pointer<map_stringitem_t>(Offset / sizeof(Index[0]));
+   Cache.HeaderP->MixedStringCount = strMixed.size();
+   Cache.HeaderP->SectionStringCount = strSections.size();
+   return true;
+}
+									/*}}}*/
+// CacheGenerator::BuildIndexes - Create the sorted lists of the cache	/*{{{*/
+// ---------------------------------------------------------------------
+/* The source cache is always extended before it is used, so storing the
+   sorted groups or the reverse index in it would only leave a stale copy
+   behind in the map. The field values can't be recreated from the cache,
+   so they are kept. */
+bool pkgCacheGenerator::BuildIndexes(bool const Final)
+{
+   if (Final == false)
+      return SortFieldValues() && StoreStringIndex();
+   return SortGroups() && SortFieldValues() && BuildReverseIndex() && StoreStringIndex();
+}
+									/*}}}*/
 uint32_t pkgCacheGenerator::AllocateInMap(const unsigned long &size) {/*{{{*/
    size_t oldSize = Map.Size();
    void const * const oldMap = Map.Data();
@@ -867,13 +1070,15 @@ map_pointer<pkgCache::Version> pkgCacheGenerator::NewVersion(pkgCache::VerIterat
 					    map_pointer<pkgCache::Version> const Next)
 {
    // Get a structure
+   auto const Extra = AllocateInMap<pkgCache::VersionExtra>();
    auto const Version = AllocateInMap<pkgCache::Version>();
-   if (Version == 0)
+   if (Extra == 0 || Version == 0)
       return 0;
    
    // Fill it in
    Ver = pkgCache::VerIterator(Cache,Cache.VerP + Version);
    //Dynamic<pkgCache::VerIterator> DynV(Ver); // caller MergeListVersion already takes care of it
+   Ver->Extra = Extra;
    Ver->NextVer = Next;
    Ver->ParentPkg = ParentPkg;
    Ver->Hash = Hash;
@@ -1092,8 +1297,21 @@ bool pkgCacheListParser::NewDepends(pkgCache::VerIterator &Ver,
    Dynamic<StringView> DynPackageName(PackageName);
    Dynamic<StringView> DynArch(Arch);
    Dynamic<StringView> DynVersion(Version);
-   if (unlikely(Owner->NewGroup(Grp, PackageName) == false))
-      return false;
+
+   /* The same few packages are depended on over and over again, so we
+      remember where we found them instead of searching the hashtable
+      and the group each time. Offsets survive a remap of the cache. */
+   pkgCache &Cache = Owner->Cache;
+   auto &Target = Owner->DependsTargets[Cache.Hash(PackageName) % Owner->DependsTargets.size()];
+   if (Target.Grp != 0 && Cache.ViewString((Cache.GrpP + Target.Grp)->Name) == PackageName)
+      Grp = pkgCache::GrpIterator(Cache, Cache.GrpP + Target.Grp);
+   else
+   {
+      if (unlikely(Owner->NewGroup(Grp, PackageName) == false))
+	 return false;
+      Target.Grp = Grp.MapPointer();
+      Target.Pkg = 0;
+   }
 
    map_stringitem_t idxVersion = 0;
    if (Version.empty() == false)
@@ -1119,11 +1337,19 @@ bool pkgCacheListParser::NewDepends(pkgCache::VerIterator &Ver,
    Dynamic<pkgCache::PkgIterator> DynPkg(Pkg);
    if (isNegative == false || (Op & pkgCache::Dep::ArchSpecific) == pkgCache::Dep::ArchSpecific || Grp->FirstPackage == 0)
    {
-      // Locate the target package
-      Pkg = Grp.FindPkg(Arch);
-      if (Pkg.end() == true) {
-	 if (unlikely(Owner->NewPackage(Pkg, PackageName, Arch) == false))
-	    return false;
+      // Locate the target package, "any" is whatever comes first in the group
+      StringView const PkgArch = (Arch == "all" || Arch == "native") ? StringView(Cache.NativeArch()) : Arch;
+      if (Target.Pkg != 0 && Arch != "any" && Cache.ViewString((Cache.PkgP + Target.Pkg)->Arch) == PkgArch)
+	 Pkg = pkgCache::PkgIterator(Cache, Cache.PkgP + Target.Pkg);
+      else
+      {
+	 Pkg = Grp.FindPkg(Arch);
+	 if (Pkg.end() == true) {
+	    if (unlikely(Owner->NewPackage(Pkg, PackageName, Arch) == false))
+	       return false;
+	 }
+	 if (Arch != "any")
+	    Target.Pkg = Pkg.MapPointer();
       }
 
       /* Caching the old end point speeds up generation substantially */
@@ -1254,6 +1480,17 @@ bool pkgCacheListParser::SameVersion(uint32_t Hash,		/*{{{*/
    return Hash == Ver->Hash;
 }
 									/*}}}*/
+// CacheGenerator::NewFieldValue - Add a value to the field index	/*{{{*/
+bool pkgCacheGenerator::NewFieldValue(pkgCache::VerIterator &Ver, StringView Field, StringView Value)
+{
+   map_stringitem_t const idxField = StoreString(MIXED, Field);
+   map_stringitem_t const idxValue = StoreString(MIXED, Value);
+   if (unlikely(idxField == 0 || idxValue == 0))
+      return false;
+   NewFieldValues.push_back({idxField, idxValue, Ver.MapPointer()});
+   return true;
+}
+									/*}}}*/
 // CacheGenerator::SelectReleaseFile - Select the current release file the indexes belong to	/*{{{*/
 bool pkgCacheGenerator::SelectReleaseFile(const string &File,const string &Site,
 				   unsigned long Flags)
@@ -1364,6 +1601,35 @@ map_stringitem_t pkgCacheGenerator::StoreString(enum StringType const type, cons
    return idxString;
 }
 									/*}}}*/
+// CacheGenerator::ReserveStrings - Presize string deduplication	/*{{{*/
+// ---------------------------------------------------------------------
+/* Most unique strings are version numbers, the other kinds are few. */
+void pkgCacheGenerator::ReserveStrings(map_id_t const Versions)
+{
+   strVersions.reserve(Versions);
+   strSections.reserve(std::min<map_id_t>(Versions, 512));
+   strMixed.reserve(64);
+}
+									/*}}}*/
+// CacheGenerator::LoadStrings - Deduplicate against an existing cache	/*{{{*/
+// ---------------------------------------------------------------------
+/* Architectures, sections, archives, origins, … are stored only once, so
+   within a cache their offsets can be used as identifiers. A cache we
+   extend (e.g. the srcpkgcache.bin with the status file) has to keep
+   this guarantee, so we learn the strings it already contains from the
+   index it was stored with. */
+void pkgCacheGenerator::LoadStrings()
+{
+   auto const Index = reinterpret_cast<map_stringitem_t const *>(Cache.HeaderP) + uint32_t(Cache.HeaderP->StringIndex);
+   auto const learn = [&](std::unordered_set<string_pointer, hash> &strings, map_stringitem_t const *I, map_id_t const Count) {
+      strings.reserve(strings.size() + Count);
+      for (auto const End = I + Count; I != End; ++I)
+	 strings.insert({nullptr, Cache.ViewString(*I).size(), this, *I});
+   };
+   learn(strMixed, Index, Cache.HeaderP->MixedStringCount);
+   learn(strSections, Index + Cache.HeaderP->MixedStringCount, Cache.HeaderP->SectionStringCount);
+}
+									/*}}}*/
 // CheckValidity - Check that a cache is up-to-date			/*{{{*/
 // ---------------------------------------------------------------------
 /* This just verifies that each file in the list of index files exists,
@@ -1388,7 +1654,7 @@ static bool CheckValidity(FileFd &CacheFile, std::string const &CacheFileName,
 
    bool const Debug = _config->FindB("Debug::pkgCacheGen", false);
    // No file, certainly invalid
-   if (CacheFile.Open(CacheFileName, FileFd::ReadOnly, FileFd::None) == false)
+   if (CacheFile.IsOpen() == false && CacheFile.Open(CacheFileName, FileFd::ReadOnly, FileFd::None) == false)
    {
       if (Debug == true)
 	 std::clog << "CacheFile " << CacheFileName << " doesn't exist" << std::endl;
@@ -1529,6 +1795,52 @@ static map_filesize_t ComputeSize(pkgSourceList const * const List, FileIterator
    return TotalSize;
 }
 									/*}}}*/
+// EstimateCacheSize - Predict the size of the cache to be built	/*{{{*/
+// ---------------------------------------------------------------------
+/* The index files usually change only slowly, so the previous cache is a
+   good prediction for the next one. Without one we guess based on the size
+   of the index files which the cache is usually smaller than. */
+struct CacheSizeEstimate
+{
+   map_filesize_t Size = 0;
+   map_id_t Versions = 0;
+};
+static CacheSizeEstimate EstimateCacheSize(std::vector<std::string> const &CacheFileNames,
+					   map_filesize_t const IndexSize)
+{
+   bool const Debug = _config->FindB("Debug::pkgCacheGen", false);
+   CacheSizeEstimate Estimate;
+   pkgCache::Header Current;
+   for (auto const &CacheFileName : CacheFileNames)
+   {
+      if (CacheFileName.empty() || RealFileExists(CacheFileName) == false)
+	 continue;
+      ScopedErrorRevert ser;
+      FileFd CacheFile;
+      pkgCache::Header Previous;
+      if (CacheFile.Open(CacheFileName, FileFd::ReadOnly) == false ||
+	  CacheFile.Read(&Previous, sizeof(Previous)) == false ||
+	  Previous.Signature != Current.Signature ||
+	  Previous.MajorVersion != Current.MajorVersion ||
+	  Previous.CheckSizes(Current) == false)
+	 continue;
+      Estimate.Size = CacheFile.Size();
+      Estimate.Versions = Previous.VersionCount;
+      if (Debug == true)
+	 std::clog << "Estimate cache size based on " << CacheFileName << ": "
+		   << Estimate.Size << " bytes, " << Estimate.Versions << " versions" << std::endl;
+      return Estimate;
+   }
+
+   // a version takes about a kilobyte in a Packages file
+   Estimate.Size = IndexSize;
+   Estimate.Versions = IndexSize / 1024;
+   if (Debug == true)
+      std::clog << "Estimate cache size based on index files: "
+		<< Estimate.Size << " bytes, " << Estimate.Versions << " versions" << std::endl;
+   return Estimate;
+}
+									/*}}}*/
 // BuildCache - Merge the list of index files into the cache		/*{{{*/
 static bool BuildCache(pkgCacheGenerator &Gen,
 		       OpProgress * const Progress,
@@ -1601,21 +1913,47 @@ static bool BuildCache(pkgCacheGenerator &Gen,
    the cache will be stored there. This is pretty much mandatory if you
    are using AllowMem. AllowMem lets the function be run as non-root
    where it builds the cache 'fast' into a memory buffer. */
-static DynamicMMap* CreateDynamicMMap(FileFd * const CacheF, unsigned long Flags)
+static DynamicMMap* CreateDynamicMMap(FileFd * const CacheF, unsigned long Flags,
+				      map_filesize_t const SizeHint = 0)
 {
-   map_filesize_t const MapStart = _config->FindI("APT::Cache-Start", 24*1024*1024);
+   map_filesize_t MapStart = _config->FindI("APT::Cache-Start", 24*1024*1024);
    map_filesize_t const MapGrow = _config->FindI("APT::Cache-Grow", 1*1024*1024);
    map_filesize_t const MapLimit = _config->FindI("APT::Cache-Limit", 0);
+   // start big enough for the expected cache plus a bit of slack,
+   // unless the user asked for a fixed size by disabling growing
+   if (SizeHint != 0 && MapGrow != 0)
+   {
+      map_filesize_t Hinted = SizeHint + std::max<map_filesize_t>(SizeHint / 8, MapGrow);
+      if (Hinted < SizeHint || (MapLimit != 0 && Hinted > MapLimit))
+	 Hinted = MapLimit != 0 ? MapLimit : SizeHint;
+      MapStart = std::max(MapStart, Hinted);
+   }
    Flags |= MMap::Moveable;
    if (_config->FindB("APT::Cache-Fallback", false) == true)
       Flags |= MMap::Fallback;
    if (CacheF != NULL)
       return new DynamicMMap(*CacheF, Flags, MapStart, MapGrow, MapLimit);
-   else
-      return new DynamicMMap(Flags, MapStart, MapGrow, MapLimit);
+
+   /* Reserving address space is cheap, while moving the map forces the
+      generator to remap all its pointers, so if we can, we reserve enough
+      space for the cache to be never moved. If the reservation is refused
+      (e.g. strict overcommit or ulimit -v) we fall back to growing. */
+   map_filesize_t MapReserve = _config->FindI("APT::Cache-Reserve", sizeof(void *) >= 8 ? 1024 * 1024 * 1024 : 0);
+   if (MapLimit != 0 && MapReserve > MapLimit)
+      MapReserve = MapLimit;
+   if (MapReserve > MapStart && MapGrow != 0 && (Flags & MMap::Fallback) != MMap::Fallback)
+   {
+      _error->PushToStack();
+      std::unique_ptr<DynamicMMap> Map(new DynamicMMap(Flags | MMap::Reserve, MapReserve, MapGrow, MapLimit));
+      bool const Reserved = Map->validData();
+      _error->RevertToStack();
+      if (Reserved)
+	 return Map.release();
+   }
+   return new DynamicMMap(Flags, MapStart, MapGrow, MapLimit);
 }
 static bool writeBackMMapToFile(pkgCacheGenerator * const Gen, DynamicMMap * const Map,
-      std::string const &FileName)
+      std::string const &FileName, bool const Final = true)
 {
    FileFd SCacheF(FileName, FileFd::WriteAtomic);
    if (SCacheF.IsOpen() == false || SCacheF.Failed())
@@ -1623,6 +1961,9 @@ static bool writeBackMMapToFile(pkgCacheGenerator * const Gen, DynamicMMap * con
 
    fchmod(SCacheF.Fd(),0644);
 
+   if (Gen->BuildIndexes(Final) == false)
+      return false;
+
    // Write out the main data
    if (SCacheF.Write(Map->Data(),Map->Size()) == false)
       return _error->Error(_("IO Error saving source cache"));
@@ -1639,11 +1980,11 @@ static bool writeBackMMapToFile(pkgCacheGenerator * const Gen, DynamicMMap * con
 static bool loadBackMMapFromFile(std::unique_ptr<pkgCacheGenerator> &Gen,
       std::unique_ptr<DynamicMMap> &Map, OpProgress * const Progress, FileFd &CacheF)
 {
-   Map.reset(CreateDynamicMMap(NULL, 0));
-   if (unlikely(Map->validData()) == false)
-      return false;
    if (CacheF.IsOpen() == false || CacheF.Seek(0) == false || CacheF.Failed())
       return false;
+   Map.reset(CreateDynamicMMap(NULL, 0, CacheF.Size()));
+   if (unlikely(Map->validData()) == false)
+      return false;
    _error->PushToStack();
    uint32_t const alloc = Map->RawAllocate(CacheF.Size());
    bool const newError = _error->PendingError();
@@ -1655,6 +1996,69 @@ static bool loadBackMMapFromFile(std::unique_ptr<pkgCacheGenerator> &Gen,
    Gen.reset(new pkgCacheGenerator(Map.get(),Progress));
    return Gen->Start();
 }
+// SharedCaches - content-addressed store of in-memory caches		/*{{{*/
+/* Processes which can't use pkgcache.bin (e.g. as it is disabled, not
+   writeable or volatile files are involved) have to build the cache in
+   memory. If Dir::Cache::SharedCaches is set they publish it there under a
+   name derived from the index files it was built from, so that others
+   building from the same files can map it read-only instead. A cache found
+   there is still checked like pkgcache.bin before it is used. */
+static std::string GetSharedCacheFilename(pkgSourceList &List, std::vector<pkgIndexFile *> const &Files)
+{
+   if (_config->Exists("Dir::Cache::SharedCaches") == false)
+      return "";
+   Hashes Hash(Hashes::SHA256SUM);
+   auto const AddLine = [&](std::string const &Line) {
+      Hash.Add(Line.c_str(), Line.length());
+      Hash.Add("\n");
+   };
+   AddLine(PACKAGE_VERSION);
+   AddLine(_config->Find("APT::Architecture"));
+   for (auto const &Arch : APT::Configuration::getArchitectures())
+      AddLine(Arch);
+   auto const AddFile = [&](pkgIndexFile const * const File) {
+      AddLine(File->Describe(false) + ' ' + std::to_string(File->Size()));
+   };
+   for (auto const &Meta : List)
+      for (auto const File : *Meta->GetIndexFiles())
+	 if (File->HasPackages())
+	    AddFile(File);
+   for (auto const File : Files)
+      AddFile(File);
+   return flCombine(_config->FindDir("Dir::Cache::SharedCaches"),
+		    "pkgcache-" + Hash.GetHashString(Hashes::SHA256SUM).HashValue() + ".bin");
+}
+static bool IsSharedCacheTrusted(FileFd &CacheFile, std::string const &FileName)
+{
+   // whoever can write the cache can make us install whatever they like
+   auto const IsTrustedOwner = [](struct stat const &Buf) {
+      return Buf.st_uid == 0 || Buf.st_uid == geteuid();
+   };
+   // and whoever can write the directory can replace it with another file
+   struct stat Buf;
+   if (stat(flNotFile(FileName).c_str(), &Buf) != 0 || IsTrustedOwner(Buf) == false ||
+	 ((Buf.st_mode & (S_IWGRP | S_IWOTH)) != 0 && (Buf.st_mode & S_ISVTX) == 0))
+      return false;
+
+   // check the file we will map, not whatever is at that path by now
+   if (RealFileExists(FileName) == false)
+      return false;
+   _error->PushToStack();
+   bool const Opened = CacheFile.Open(FileName, FileFd::ReadOnly, FileFd::None);
+   _error->RevertToStack();
+   if (Opened == false || fstat(CacheFile.Fd(), &Buf) != 0)
+      return false;
+   return IsTrustedOwner(Buf) && (Buf.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+static void PutSharedCache(pkgCacheGenerator * const Gen, DynamicMMap * const Map, std::string const &FileName)
+{
+   if (access(flNotFile(FileName).c_str(), W_OK) != 0)
+      return;
+   _error->PushToStack();
+   writeBackMMapToFile(Gen, Map, FileName);
+   _error->RevertToStack();
+}
+									/*}}}*/
 bool pkgCacheGenerator::MakeStatusCache(pkgSourceList &List,OpProgress *Progress,
 			MMap **OutMap,bool)
 {
@@ -1703,6 +2107,30 @@ bool pkgCacheGenerator::MakeStatusCache(pkgSourceList &List,OpProgress *Progress
       srcpkgcache_fine = true;
    }
 
+   // with a pkgcache.bin we can use as-is there is nothing to share
+   std::string SharedCacheFileName;
+   if (pkgcache_fine == false || volatile_fine == false)
+   {
+      if (CacheFileName.empty() == true || volatile_fine == false ||
+	    access(flNotFile(CacheFileName).c_str(), W_OK) != 0)
+      {
+	 std::vector<pkgIndexFile *> AllFiles = Files;
+	 for (auto const File : List.GetVolatileFiles())
+	    AllFiles.push_back(File);
+	 SharedCacheFileName = GetSharedCacheFilename(List, AllFiles);
+	 FileFd SharedCacheFile;
+	 if (SharedCacheFileName.empty() == false && IsSharedCacheTrusted(SharedCacheFile, SharedCacheFileName) &&
+	       CheckValidity(SharedCacheFile, SharedCacheFileName, List, AllFiles.begin(), AllFiles.end(), OutMap, OutCache) == true)
+	 {
+	    if (Debug == true)
+	       std::clog << "Shared cache " << SharedCacheFileName << " is valid - no need to build any cache" << std::endl;
+	    if (Progress != NULL)
+	       Progress->OverallProgress(1,1,1,_("Reading package lists"));
+	    return true;
+	 }
+      }
+   }
+
    FileFd SrcCacheFile;
    if (pkgcache_fine == false)
    {
@@ -1733,16 +2161,11 @@ bool pkgCacheGenerator::MakeStatusCache(pkgSourceList &List,OpProgress *Progress
 	 std::clog << "Do we have write-access to the cache files? " << (Writeable ? "YES" : "NO") << std::endl;
    }
 
-   // At this point we know we need to construct something, so get storage ready
-   std::unique_ptr<DynamicMMap> Map(CreateDynamicMMap(NULL, 0));
-   if (unlikely(Map->validData()) == false)
-      return false;
-   if (Debug == true)
-      std::clog << "Open memory Map (not filebased)" << std::endl;
-
+   // At this point we know we need to construct something
+   std::vector<pkgIndexFile*> VolatileFiles = List.GetVolatileFiles();
+   std::unique_ptr<DynamicMMap> Map;
    std::unique_ptr<pkgCacheGenerator> Gen{nullptr};
    map_filesize_t CurrentSize = 0;
-   std::vector<pkgIndexFile*> VolatileFiles = List.GetVolatileFiles();
    map_filesize_t TotalSize = ComputeSize(NULL, VolatileFiles.begin(), VolatileFiles.end());
    if (srcpkgcache_fine == true && pkgcache_fine == false)
    {
@@ -1750,6 +2173,8 @@ bool pkgCacheGenerator::MakeStatusCache(pkgSourceList &List,OpProgress *Progress
 	 std::clog << "srcpkgcache.bin was valid - populate MMap with it" << std::endl;
       if (loadBackMMapFromFile(Gen, Map, Progress, SrcCacheFile) == false)
 	 return false;
+      // the valid srcpkgcache.bin is there to base the estimate on
+      Gen->ReserveStrings(EstimateCacheSize({CacheFileName, SrcCacheFileName}, 0).Versions);
       srcpkgcache_fine = true;
       TotalSize += ComputeSize(NULL, Files.begin(), Files.end());
    }
@@ -1757,17 +2182,24 @@ bool pkgCacheGenerator::MakeStatusCache(pkgSourceList &List,OpProgress *Progress
    {
       if (Debug == true)
 	 std::clog << "srcpkgcache.bin is NOT valid - rebuild" << std::endl;
+      TotalSize += ComputeSize(&List, Files.begin(), Files.end());
+      auto const Estimate = EstimateCacheSize({CacheFileName, SrcCacheFileName}, TotalSize);
+      Map.reset(CreateDynamicMMap(NULL, 0, Estimate.Size));
+      if (unlikely(Map->validData()) == false)
+	 return false;
+      if (Debug == true)
+	 std::clog << "Open memory Map (not filebased)" << std::endl;
       Gen.reset(new pkgCacheGenerator(Map.get(),Progress));
+      Gen->ReserveStrings(Estimate.Versions);
       if (Gen->Start() == false)
 	 return false;
 
-      TotalSize += ComputeSize(&List, Files.begin(),Files.end());
       if (BuildCache(*Gen, Progress, CurrentSize, TotalSize, &List,
 	       Files.end(),Files.end()) == false)
 	 return false;
 
       if (Writeable == true && SrcCacheFileName.empty() == false)
-	 if (writeBackMMapToFile(Gen.get(), Map.get(), SrcCacheFileName) == false)
+	 if (writeBackMMapToFile(Gen.get(), Map.get(), SrcCacheFileName, false) == false)
 	    return false;
    }
 
@@ -1803,6 +2235,13 @@ bool pkgCacheGenerator::MakeStatusCache(pkgSourceList &List,OpProgress *Progress
 	 return false;
    }
 
+   if (SharedCacheFileName.empty() == false)
+   {
+      if (Debug == true)
+	 std::clog << "Publishing the cache as " << SharedCacheFileName << std::endl;
+      PutSharedCache(Gen.get(), Map.get(), SharedCacheFileName);
+   }
+
    if (OutMap != nullptr)
       *OutMap = Map.release();
 
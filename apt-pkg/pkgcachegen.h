@@ -74,6 +74,19 @@ class APT_HIDDEN pkgCacheGenerator					/*{{{*/
    std::unordered_set<string_pointer, hash> strMixed;
    std::unordered_set<string_pointer, hash> strVersions;
    std::unordered_set<string_pointer, hash> strSections;
+   /** \brief fill the deduplication with the strings of an existing cache */
+   APT_HIDDEN void LoadStrings();
+
+   /** \brief recently resolved dependency targets, indexed by name hash */
+   struct DependsTarget
+   {
+      map_pointer<pkgCache::Group> Grp;
+      map_pointer<pkgCache::Package> Pkg;
+   };
+   std::vector<DependsTarget> DependsTargets;
+
+   /** \brief values of indexed fields not yet merged into the cache index */
+   std::vector<pkgCache::FieldValue> NewFieldValues;
 #endif
 
    friend class pkgCacheListParser;
@@ -122,6 +135,7 @@ class APT_HIDDEN pkgCacheGenerator					/*{{{*/
 		   uint8_t const Type, map_pointer<pkgCache::Dependency>* &OldDepLast);
    bool NewProvides(pkgCache::VerIterator &Ver, pkgCache::PkgIterator &Pkg,
 		    map_stringitem_t const ProvidesVersion, uint8_t const Flags);
+   APT_HIDDEN bool NewFieldValue(pkgCache::VerIterator &Ver, APT::StringView Field, APT::StringView Value);
 
    public:
 
@@ -130,6 +144,13 @@ class APT_HIDDEN pkgCacheGenerator					/*{{{*/
 
    inline map_stringitem_t StoreString(enum StringType const type, APT::StringView S) {return StoreString(type, S.data(),S.length());};
 
+   /** \brief (re)create the sorted indexes if items were added to the cache
+    *
+    *  \param Final is \b false for the source cache, which only gets the
+    *  indexes which can't be recreated later on */
+   APT_HIDDEN bool BuildIndexes(bool const Final = true);
+   /** \brief size the string deduplication for the expected amount of versions */
+   APT_HIDDEN void ReserveStrings(map_id_t const Versions);
    void DropProgress() {Progress = 0;};
    bool SelectFile(const std::string &File,pkgIndexFile const &Index, std::string const &Architecture, std::string const &Component, unsigned long Flags = 0);
    bool SelectReleaseFile(const std::string &File, const std::string &Site, unsigned long Flags = 0);
@@ -165,6 +186,11 @@ class APT_HIDDEN pkgCacheGenerator					/*{{{*/
 
    APT_HIDDEN bool AddNewDescription(ListParser &List, pkgCache::VerIterator &Ver,
 	 std::string const &lang, APT::StringView CurMd5, map_stringitem_t &md5idx);
+
+   APT_HIDDEN bool SortGroups();
+   APT_HIDDEN bool SortFieldValues();
+   APT_HIDDEN bool BuildReverseIndex();
+   APT_HIDDEN bool StoreStringIndex();
 };
 									/*}}}*/
 // This is the abstract package list parser class.			/*{{{*/
@@ -186,6 +212,7 @@ class APT_HIDDEN pkgCacheListParser
    inline map_stringitem_t WriteString(APT::StringView S) {return Owner->WriteStringInMap(S.data(), S.size());};
 
    inline map_stringitem_t WriteString(const char *S,unsigned int Size) {return Owner->WriteStringInMap(S,Size);};
+   inline bool NewFieldValue(pkgCache::VerIterator &Ver, APT::StringView Field, APT::StringView Value) {return Owner->NewFieldValue(Ver, Field, Value);};
    bool NewDepends(pkgCache::VerIterator &Ver,APT::StringView Package, APT::StringView Arch,
 		   APT::StringView Version,uint8_t const Op,
 		   uint8_t const Type);
@@ -10,13 +10,19 @@
 // Include Files							/*{{{*/
 #include <config.h>
 
+#include <apt-pkg/aptconfiguration.h>
 #include <apt-pkg/error.h>
 #include <apt-pkg/indexfile.h>
 #include <apt-pkg/pkgcache.h>
 #include <apt-pkg/pkgrecords.h>
+#include <apt-pkg/strutl.h>
 
+#include <algorithm>
+#include <string>
 #include <vector>
+#include <fcntl.h>
 #include <stddef.h>
+#include <unistd.h>
 
 #include <apti18n.h>
 									/*}}}*/
@@ -74,6 +80,69 @@ pkgRecords::Parser &pkgRecords::Lookup(pkgCache::DescFileIterator const &Desc)
    return *Files[Desc.File()->ID];
 }
 									/*}}}*/
+// Records::Lookup - Visit a batch of records in file order		/*{{{*/
+// ---------------------------------------------------------------------
+/* Records are small and scattered over big files, so reading them in
+   the order the caller happens to have them in seeks back and forth.
+   Instead we sort them and hint the kernel to prefetch each range we are
+   going to read before we parse the first record in it. */
+static void PrefetchRange(std::string const &FileName, unsigned long long const Start,
+			  unsigned long long const End)
+{
+#ifdef POSIX_FADV_WILLNEED
+   // the offsets of compressed files do not refer to the file on disk
+   for (auto const &Ext : APT::Configuration::getCompressorExtensions())
+      if (APT::String::Endswith(FileName, Ext))
+	 return;
+   int const fd = open(FileName.c_str(), O_RDONLY | O_CLOEXEC);
+   if (fd == -1)
+      return;
+   posix_fadvise(fd, Start, End - Start, POSIX_FADV_WILLNEED);
+   close(fd);
+#else
+   (void)FileName; (void)Start; (void)End;
+#endif
+}
+template<class Iterator> bool pkgRecords::LookupSorted(std::vector<Iterator> &Items,
+      std::function<bool(Iterator const &, Parser &)> const &Callback)
+{
+   Items.erase(std::remove_if(Items.begin(), Items.end(), [](Iterator const &I) { return I.end(); }), Items.end());
+   std::sort(Items.begin(), Items.end(), [](Iterator const &A, Iterator const &B) {
+      if (A->File != B->File)
+	 return A->File < B->File;
+      return A->Offset < B->Offset;
+   });
+
+   for (auto I = Items.begin(); I != Items.end();)
+   {
+      auto const File = I->File();
+      auto FileEnd = I;
+      for (; FileEnd != Items.end() && (*FileEnd)->File == (*I)->File; ++FileEnd);
+      auto const Last = FileEnd - 1;
+      PrefetchRange(File.FileName(), (*I)->Offset, (*Last)->Offset + (*Last)->Size);
+
+      Parser * const P = Files[File->ID];
+      for (; I != FileEnd; ++I)
+      {
+	 if (P->Jump(*I) == false)
+	    return false;
+	 if (Callback(*I, *P) == false)
+	    return false;
+      }
+   }
+   return true;
+}
+bool pkgRecords::Lookup(std::vector<pkgCache::VerFileIterator> VerFiles,
+      std::function<bool(pkgCache::VerFileIterator const &, Parser &)> const &Callback)
+{
+   return LookupSorted(VerFiles, Callback);
+}
+bool pkgRecords::Lookup(std::vector<pkgCache::DescFileIterator> DescFiles,
+      std::function<bool(pkgCache::DescFileIterator const &, Parser &)> const &Callback)
+{
+   return LookupSorted(DescFiles, Callback);
+}
+									/*}}}*/
 
 pkgRecords::Parser::Parser() : d(NULL) {}
 pkgRecords::Parser::~Parser() {}
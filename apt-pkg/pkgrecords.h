@@ -20,6 +20,7 @@
 #include <apt-pkg/macros.h>
 #include <apt-pkg/pkgcache.h>
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -35,11 +36,30 @@ class APT_PUBLIC pkgRecords							/*{{{*/
    pkgCache &Cache;
    std::vector<Parser *>Files;
 
+   template<class Iterator> APT_HIDDEN bool LookupSorted(std::vector<Iterator> &Items,
+	 std::function<bool(Iterator const &, Parser &)> const &Callback);
+
     public:
    // Lookup function
    Parser &Lookup(pkgCache::VerFileIterator const &Ver);
    Parser &Lookup(pkgCache::DescFileIterator const &Desc);
 
+   /** \brief look up many records in the order they are stored in
+    *
+    * The records are visited sorted by the file they are in and their
+    * offset in it, so each file is read front to back once, and the kernel
+    * is asked to read ahead the part of the file they span.
+    *
+    * \param Callback is called for each record with the parser positioned
+    * on it. Returning \b false stops the iteration.
+    * \return \b false if a callback returned \b false or a record could
+    * not be read, \b true otherwise.
+    */
+   bool Lookup(std::vector<pkgCache::VerFileIterator> VerFiles,
+	       std::function<bool(pkgCache::VerFileIterator const &, Parser &)> const &Callback);
+   bool Lookup(std::vector<pkgCache::DescFileIterator> DescFiles,
+	       std::function<bool(pkgCache::DescFileIterator const &, Parser &)> const &Callback);
+
    // Construct destruct
    explicit pkgRecords(pkgCache &Cache);
    virtual ~pkgRecords();
@@ -0,0 +1,855 @@
+// -*- mode: cpp; mode: fold -*-
+// Description								/*{{{*/
+/* ######################################################################
+
+   Cache Proxy - A caching HTTP proxy for APT repositories
+
+   Requests are answered from the cache directory if possible, otherwise
+   the file is fetched from upstream by a child process using the acquire
+   system (and so its http method and hash verification) and answered once
+   it is done. All clients are served by a single poll() based event loop.
+
+   Files below dists/ are only served from the cache as long as they match
+   the hashes listed in the cached InRelease (or Release) file of their
+   suite, which itself is always revalidated upstream. Files in the pool
+   are served from cache as long as they match the hashes listed in a cached
+   Packages file of a suite seen by the proxy. by-hash files are named after
+   their hash and so are served from cache forever. Everything else is
+   always fetched from upstream.
+
+   ##################################################################### */
+									/*}}}*/
+// Include Files							/*{{{*/
+#include <config.h>
+
+#include <apt-pkg/acquire-item.h>
+#include <apt-pkg/acquire.h>
+#include <apt-pkg/aptconfiguration.h>
+#include <apt-pkg/cmndline.h>
+#include <apt-pkg/configuration.h>
+#include <apt-pkg/error.h>
+#include <apt-pkg/fileutl.h>
+#include <apt-pkg/gpgv.h>
+#include <apt-pkg/hashes.h>
+#include <apt-pkg/strutl.h>
+#include <apt-pkg/tagfile.h>
+
+#include <apt-private/private-cache-proxy.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <apti18n.h>
+									/*}}}*/
+
+namespace
+{
+// requests are read only once the previous one was answered
+constexpr size_t MaxRequestSize = 64 * 1024;
+
+enum class CachePolicy
+{
+   // e.g. InRelease files can change at any time, so ask upstream each time
+   VOLATILE,
+   // indexes and pool files are valid as long as they match the hashes
+   // listed in the cached InRelease or Packages files
+   VERIFIED,
+   // by-hash files never change their content
+   FOREVER,
+};
+
+struct ProxyClient
+{
+   int Fd;
+   std::string In;
+   std::string Out;
+   FileFd File;
+   unsigned long long Remaining = 0;
+   bool Waiting = false;
+   bool Close = false;
+   bool HeadOnly = false;
+   time_t IfModifiedSince = 0;
+
+   explicit ProxyClient(int const Fd) : Fd(Fd) {}
+};
+
+struct PoolSource
+{
+   // the mtime of the cached Packages file when the files were read from it
+   time_t MTime = 0;
+   std::unordered_map<std::string, HashStringList> Files;
+};
+
+struct ProxyFetch
+{
+   pid_t Child;
+   std::string Result;
+   std::string Partial;
+   std::string Final;
+   CachePolicy Policy;
+   HashStringList Hashes;
+   // the archive root if an index was fetched
+   std::string Root;
+   std::vector<unsigned long> Clients;
+};
+
+class CacheProxy
+{
+   std::string const Directory;
+   std::vector<int> const Listen;
+   std::vector<std::string> const Upstreams;
+   unsigned long NextClient = 0;
+   std::map<unsigned long, ProxyClient> Clients;
+   std::map<int, ProxyFetch> Fetches;
+   // files which were checked against the hashes in their InRelease file already
+   std::map<std::string, std::pair<std::string, time_t>> Verified;
+   // the suites seen for each archive root and the files in their pools
+   std::map<std::string, std::set<std::string>> Suites;
+   std::map<std::string, std::map<std::string, PoolSource>> PoolIndexes;
+
+   std::string CacheFilename(std::string const &URI) const
+   {
+      return Directory + URItoFileName(URI);
+   }
+   bool LookupReleaseHashes(std::string const &Root, std::string const &Path, HashStringList &Hashes) const;
+   std::map<std::string, std::string> FindPackagesFiles(std::string const &Suite) const;
+   void UpdatePoolIndex(std::string const &Root);
+   bool LookupPoolHashes(std::string const &Root, std::string const &Path, HashStringList &Hashes) const;
+   CachePolicy Classify(std::string const &URI, HashStringList &Hashes);
+   bool IsCacheValid(std::string const &Final, CachePolicy const Policy, HashStringList const &Hashes) const;
+
+   bool IsUpstreamAllowed(std::string const &URI) const;
+   void Accept(int const Fd);
+   bool Read(ProxyClient &Client);
+   bool Write(ProxyClient &Client);
+   void Drop(unsigned long const ID);
+   void Progress(unsigned long const ID);
+   void HandleRequest(unsigned long const ID, ProxyClient &Client);
+   void SendHeader(ProxyClient &Client, std::string const &Status, std::string const &Headers = "");
+   void SendFile(ProxyClient &Client, std::string const &Final);
+   void StartFetch(unsigned long const ID, std::string const &URI, std::string const &Final,
+		   CachePolicy const Policy, HashStringList const &Hashes);
+   void FinishFetch(int const Fd);
+
+   public:
+   bool Run();
+
+   CacheProxy(std::string const &Directory, std::vector<int> &&Listen) : Directory(Directory), Listen(std::move(Listen)),
+	Upstreams(_config->FindVector("APT::Cache-Proxy::Upstream")) {}
+};
+}
+
+// CacheProxy::LookupReleaseHashes - find hashes of an index in InRelease	/*{{{*/
+bool CacheProxy::LookupReleaseHashes(std::string const &Root, std::string const &Path, HashStringList &Hashes) const
+{
+   for (auto const Name : {"InRelease", "Release"})
+   {
+      std::string const ReleaseFile = CacheFilename(Root + Name);
+      if (RealFileExists(ReleaseFile) == false)
+	 continue;
+
+      bool Found = false;
+      _error->PushToStack();
+      FileFd Fd;
+      if (OpenMaybeClearSignedFile(ReleaseFile, Fd) == true)
+      {
+	 pkgTagFile TagFile(&Fd, Fd.Size());
+	 pkgTagSection Section;
+	 if (TagFile.Step(Section) == true)
+	 {
+	    for (auto const Type : {"SHA512", "SHA256"})
+	    {
+	       std::istringstream Entries(Section.FindS(Type));
+	       std::string Hash, Size, File;
+	       while (Entries >> Hash >> Size >> File)
+	       {
+		  if (File != Path)
+		     continue;
+		  Hashes.push_back(HashString(Type, Hash));
+		  Hashes.FileSize(strtoull(Size.c_str(), nullptr, 10));
+		  Found = true;
+		  break;
+	       }
+	    }
+	 }
+      }
+      _error->RevertToStack();
+      return Found;
+   }
+   return false;
+}
+									/*}}}*/
+// CacheProxy::FindPackagesFiles - cached Packages files of a suite	/*{{{*/
+/* Returns the cached files with the compressed name they are listed with in
+   the release file, which could be cached under their by-hash name, too. */
+std::map<std::string, std::string> CacheProxy::FindPackagesFiles(std::string const &Suite) const
+{
+   std::map<std::string, std::string> Files;
+   for (auto const Name : {"InRelease", "Release"})
+   {
+      std::string const ReleaseFile = CacheFilename(Suite + Name);
+      if (RealFileExists(ReleaseFile) == false)
+	 continue;
+
+      _error->PushToStack();
+      FileFd Fd;
+      if (OpenMaybeClearSignedFile(ReleaseFile, Fd) == true)
+      {
+	 pkgTagFile TagFile(&Fd, Fd.Size());
+	 pkgTagSection Section;
+	 if (TagFile.Step(Section) == true)
+	 {
+	    std::istringstream Entries(Section.FindS("SHA256"));
+	    std::string Hash, Size, Path;
+	    while (Entries >> Hash >> Size >> Path)
+	    {
+	       std::string const Base = flNotDir(Path);
+	       if (Base != "Packages" && APT::String::Startswith(Base, "Packages.") == false)
+		  continue;
+	       auto const FileSize = strtoull(Size.c_str(), nullptr, 10);
+	       for (auto const &File : {CacheFilename(Suite + Path),
+					CacheFilename(Suite + flNotFile(Path) + "by-hash/SHA256/" + Hash)})
+	       {
+		  struct stat Buf;
+		  if (stat(File.c_str(), &Buf) == 0 && static_cast<unsigned long long>(Buf.st_size) == FileSize)
+		  {
+		     Files.emplace(File, Path);
+		     break;
+		  }
+	       }
+	    }
+	 }
+      }
+      _error->RevertToStack();
+      break;
+   }
+   return Files;
+}
+									/*}}}*/
+// CacheProxy::UpdatePoolIndex - read the files in the pool of an archive	/*{{{*/
+/* Called whenever an index of the archive was fetched, so that looking up
+   a pool file never has to parse anything. Only the Packages files which
+   are new or changed since the last time are read again. */
+void CacheProxy::UpdatePoolIndex(std::string const &Root)
+{
+   std::map<std::string, std::string> Files;
+   for (auto const &Suite : Suites[Root])
+      for (auto &&File : FindPackagesFiles(Suite))
+	 Files.emplace(std::move(File));
+
+   auto &Index = PoolIndexes[Root];
+   for (auto S = Index.begin(); S != Index.end();)
+      if (Files.find(S->first) == Files.end())
+	 S = Index.erase(S);
+      else
+	 ++S;
+
+   auto const Compressors = APT::Configuration::getCompressors();
+   for (auto const &File : Files)
+   {
+      struct stat Buf;
+      if (stat(File.first.c_str(), &Buf) != 0)
+	 continue;
+      auto &Source = Index[File.first];
+      if (Source.MTime == Buf.st_mtime)
+	 continue;
+      Source.MTime = Buf.st_mtime;
+      Source.Files.clear();
+
+      auto Compressor = std::find_if(Compressors.begin(), Compressors.end(), [&](APT::Configuration::Compressor const &C) {
+	 return C.Extension.empty() == false && APT::String::Endswith(File.second, C.Extension);
+      });
+      if (Compressor == Compressors.end())
+	 Compressor = std::find_if(Compressors.begin(), Compressors.end(), [](APT::Configuration::Compressor const &C) {
+	    return C.Name == ".";
+	 });
+      if (Compressor == Compressors.end())
+	 continue;
+
+      _error->PushToStack();
+      FileFd Fd;
+      if (Fd.Open(File.first, FileFd::ReadOnly, *Compressor) == true)
+      {
+	 pkgTagFile TagFile(&Fd);
+	 pkgTagSection Section;
+	 while (TagFile.Step(Section) == true)
+	 {
+	    std::string const Filename = Section.FindS("Filename");
+	    if (Filename.empty())
+	       continue;
+	    HashStringList FileHashes;
+	    for (auto const Type : {"SHA512", "SHA256"})
+	    {
+	       std::string const Hash = Section.FindS(Type);
+	       if (Hash.empty() == false)
+		  FileHashes.push_back(HashString(Type, Hash));
+	    }
+	    if (FileHashes.usable() == false)
+	       continue;
+	    FileHashes.FileSize(Section.FindULL("Size"));
+	    Source.Files.emplace(Filename, std::move(FileHashes));
+	 }
+      }
+      _error->RevertToStack();
+   }
+}
+									/*}}}*/
+// CacheProxy::LookupPoolHashes - find hashes of a pool file		/*{{{*/
+bool CacheProxy::LookupPoolHashes(std::string const &Root, std::string const &Path, HashStringList &Hashes) const
+{
+   auto const Index = PoolIndexes.find(Root);
+   if (Index == PoolIndexes.end())
+      return false;
+   for (auto const &Source : Index->second)
+   {
+      auto const F = Source.second.Files.find(Path);
+      if (F == Source.second.Files.end())
+	 continue;
+      Hashes = F->second;
+      return true;
+   }
+   return false;
+}
+									/*}}}*/
+// CacheProxy::Classify - decide how long a file can be cached		/*{{{*/
+CachePolicy CacheProxy::Classify(std::string const &URI, HashStringList &Hashes)
+{
+   auto const ByHash = URI.find("/by-hash/");
+   if (ByHash != std::string::npos)
+   {
+      auto const TypeStart = ByHash + strlen("/by-hash/");
+      auto const TypeEnd = URI.find('/', TypeStart);
+      if (TypeEnd == std::string::npos)
+	 return CachePolicy::VOLATILE;
+      std::string const Type = URI.substr(TypeStart, TypeEnd - TypeStart);
+      if (Type != "SHA256" && Type != "SHA512")
+	 return CachePolicy::VOLATILE;
+      Hashes.push_back(HashString(Type, URI.substr(TypeEnd + 1)));
+      return CachePolicy::FOREVER;
+   }
+
+   auto const Dists = URI.find("/dists/");
+   if (Dists != std::string::npos)
+   {
+      auto const SuiteEnd = URI.find('/', Dists + strlen("/dists/"));
+      if (SuiteEnd == std::string::npos)
+	 return CachePolicy::VOLATILE;
+      std::string const Suite = URI.substr(0, SuiteEnd + 1);
+      std::string const Path = URI.substr(SuiteEnd + 1);
+      if (Path == "InRelease" || Path == "Release" || Path == "Release.gpg")
+      {
+	 Suites[URI.substr(0, Dists + 1)].insert(Suite);
+	 return CachePolicy::VOLATILE;
+      }
+      if (LookupReleaseHashes(Suite, Path, Hashes) == true)
+	 return CachePolicy::VERIFIED;
+      return CachePolicy::VOLATILE;
+   }
+
+   auto const Pool = URI.find("/pool/");
+   if (Pool != std::string::npos && LookupPoolHashes(URI.substr(0, Pool + 1), URI.substr(Pool + 1), Hashes) == true)
+      return CachePolicy::VERIFIED;
+   return CachePolicy::VOLATILE;
+}
+									/*}}}*/
+// CacheProxy::IsCacheValid - can the request be answered from cache	/*{{{*/
+/* Files are hashed by the fetch child, which verifies a file found in the
+   cache before it downloads it again, so this only has to remember which
+   files were verified already. */
+bool CacheProxy::IsCacheValid(std::string const &Final, CachePolicy const Policy, HashStringList const &ExpectedHashes) const
+{
+   if (Policy == CachePolicy::VOLATILE)
+      return false;
+
+   struct stat Buf;
+   if (stat(Final.c_str(), &Buf) != 0)
+      return false;
+   if (Policy == CachePolicy::FOREVER)
+      return true;
+
+   if (ExpectedHashes.FileSize() != 0 && ExpectedHashes.FileSize() != static_cast<unsigned long long>(Buf.st_size))
+      return false;
+   std::string const Expected = ExpectedHashes.find(nullptr)->toStr();
+   auto const V = Verified.find(Final);
+   return V != Verified.end() && V->second.first == Expected && V->second.second == Buf.st_mtime;
+}
+									/*}}}*/
+// CacheProxy::SendHeader - queue a response header			/*{{{*/
+void CacheProxy::SendHeader(ProxyClient &Client, std::string const &Status, std::string const &Headers)
+{
+   Client.Out.append("HTTP/1.1 ").append(Status).append("\r\n");
+   Client.Out.append(Headers);
+   if (Headers.find("Content-Length:") == std::string::npos)
+      Client.Out.append("Content-Length: 0\r\n");
+   Client.Out.append("Server: APT cache-proxy\r\n");
+   Client.Out.append(Client.Close ? "Connection: close\r\n" : "Connection: keep-alive\r\n");
+   Client.Out.append("\r\n");
+}
+									/*}}}*/
+// CacheProxy::SendFile - answer the request with a file from the cache	/*{{{*/
+void CacheProxy::SendFile(ProxyClient &Client, std::string const &Final)
+{
+   struct stat Buf;
+   if (stat(Final.c_str(), &Buf) != 0)
+      return SendHeader(Client, "404 Not Found");
+
+   std::string const LastModified = "Last-Modified: " + TimeRFC1123(Buf.st_mtime, false) + "\r\n";
+   if (Client.IfModifiedSince != 0 && Buf.st_mtime <= Client.IfModifiedSince)
+      return SendHeader(Client, "304 Not Modified", LastModified);
+
+   if (Client.HeadOnly == false && Client.File.Open(Final, FileFd::ReadOnly) == false)
+   {
+      _error->DumpErrors(std::cerr);
+      return SendHeader(Client, "500 Internal Server Error");
+   }
+   std::string Headers;
+   strprintf(Headers, "Content-Length: %llu\r\n", static_cast<unsigned long long>(Buf.st_size));
+   SendHeader(Client, "200 OK", Headers + LastModified);
+   if (Client.HeadOnly == false)
+      Client.Remaining = Buf.st_size;
+}
+									/*}}}*/
+// CacheProxy::StartFetch - let a child fetch the file from upstream	/*{{{*/
+void CacheProxy::StartFetch(unsigned long const ID, std::string const &URI, std::string const &Final,
+			    CachePolicy const Policy, HashStringList const &Hashes)
+{
+   Clients.at(ID).Waiting = true;
+   for (auto &F : Fetches)
+      if (F.second.Final == Final)
+      {
+	 F.second.Clients.push_back(ID);
+	 return;
+      }
+
+   ProxyFetch Fetch;
+   Fetch.Final = Final;
+   Fetch.Partial = Directory + "partial/" + flNotDir(Final);
+   Fetch.Policy = Policy;
+   Fetch.Hashes = Hashes;
+   auto const Dists = URI.find("/dists/");
+   if (Dists != std::string::npos)
+      Fetch.Root = URI.substr(0, Dists + 1);
+   Fetch.Clients.push_back(ID);
+   RemoveFile("StartFetch", Fetch.Partial);
+
+   int Pipe[2];
+   if (pipe(Pipe) != 0)
+   {
+      _error->Errno("pipe", "Failed to create IPC pipe to subprocess");
+      _error->DumpErrors(std::cerr);
+      Clients.at(ID).Waiting = false;
+      return SendHeader(Clients.at(ID), "500 Internal Server Error");
+   }
+   Fetch.Child = ExecFork({Pipe[1]});
+   if (Fetch.Child == 0)
+   {
+      // a file which is still good needs no download
+      if (Policy == CachePolicy::VERIFIED && Hashes.usable() && RealFileExists(Final))
+      {
+	 FileFd Fd(Final, FileFd::ReadOnly);
+	 class Hashes Hash(Hashes);
+	 if (Fd.IsOpen() && Hash.AddFD(Fd) && Hash.GetHashStringList() == Hashes)
+	    _exit(0);
+	 _error->Discard();
+      }
+      pkgAcquire Fetcher;
+      auto const Item = new pkgAcqFile(&Fetcher, URI, Hashes, Hashes.FileSize(), URI, URI, "", Fetch.Partial);
+      Fetcher.Run();
+      std::string Result;
+      if (Item->Status != pkgAcquire::Item::StatDone || Item->Complete == false)
+	 Result = Item->ErrorText.empty() ? "Failed" : Item->ErrorText;
+      FileFd::Write(Pipe[1], Result.c_str(), Result.length());
+      _exit(0);
+   }
+   close(Pipe[1]);
+   Fetches.emplace(Pipe[0], std::move(Fetch));
+}
+									/*}}}*/
+// CacheProxy::FinishFetch - answer everyone waiting for a fetch	/*{{{*/
+void CacheProxy::FinishFetch(int const Fd)
+{
+   auto F = Fetches.find(Fd);
+   ProxyFetch Fetch = std::move(F->second);
+   Fetches.erase(F);
+   close(Fd);
+   bool const Exited = ExecWait(Fetch.Child, "cache-proxy", true);
+
+   // without a partial file the child verified the cached file instead
+   bool Success = Exited && Fetch.Result.empty() && (RealFileExists(Fetch.Partial) || RealFileExists(Fetch.Final));
+   if (Success)
+   {
+      if (RealFileExists(Fetch.Partial) && rename(Fetch.Partial.c_str(), Fetch.Final.c_str()) != 0)
+      {
+	 _error->Errno("rename", "Failed to rename %s to %s", Fetch.Partial.c_str(), Fetch.Final.c_str());
+	 _error->DumpErrors(std::cerr);
+	 Success = false;
+      }
+      struct stat Buf;
+      if (Success && Fetch.Policy == CachePolicy::VERIFIED && stat(Fetch.Final.c_str(), &Buf) == 0)
+	 Verified[Fetch.Final] = {Fetch.Hashes.find(nullptr)->toStr(), Buf.st_mtime};
+   }
+   else
+   {
+      RemoveFile("FinishFetch", Fetch.Partial);
+      std::clog << "Failed to fetch " << flNotDir(Fetch.Final) << ": " << Fetch.Result << std::endl;
+   }
+
+   if (Fetch.Root.empty() == false)
+      UpdatePoolIndex(Fetch.Root);
+
+   bool const NotFound = Fetch.Result.compare(0, 3, "404") == 0;
+   // if upstream is unreachable, a stale index is better than nothing
+   bool const Stale = Success == false && NotFound == false &&
+		      Fetch.Policy == CachePolicy::VOLATILE && RealFileExists(Fetch.Final);
+   for (auto const ID : Fetch.Clients)
+   {
+      auto C = Clients.find(ID);
+      if (C == Clients.end())
+	 continue;
+      C->second.Waiting = false;
+      if (Success || Stale)
+	 SendFile(C->second, Fetch.Final);
+      else if (NotFound)
+	 SendHeader(C->second, "404 Not Found");
+      else
+	 SendHeader(C->second, "502 Bad Gateway");
+      Progress(ID);
+   }
+}
+									/*}}}*/
+// CacheProxy::IsUpstreamAllowed - may requests for URI be forwarded	/*{{{*/
+bool CacheProxy::IsUpstreamAllowed(std::string const &URI) const
+{
+   if (Upstreams.empty())
+      return true;
+   ::URI const U(URI);
+   std::string const HostPort = U.Port != 0 ? U.Host + ':' + std::to_string(U.Port) : U.Host;
+   return std::any_of(Upstreams.begin(), Upstreams.end(), [&](std::string const &Upstream) {
+      return strcasecmp(Upstream.c_str(), U.Host.c_str()) == 0 || strcasecmp(Upstream.c_str(), HostPort.c_str()) == 0;
+   });
+}
+									/*}}}*/
+// CacheProxy::HandleRequest - parse and answer the next request	/*{{{*/
+void CacheProxy::HandleRequest(unsigned long const ID, ProxyClient &Client)
+{
+   auto const End = Client.In.find("\r\n\r\n");
+   if (End == std::string::npos)
+   {
+      if (Client.In.length() > MaxRequestSize)
+      {
+	 Client.Close = true;
+	 SendHeader(Client, "431 Request Header Fields Too Large");
+      }
+      return;
+   }
+   std::vector<std::string> const Lines = VectorizeString(Client.In.substr(0, End), '\n');
+   Client.In.erase(0, End + 4);
+
+   std::vector<std::string> Request;
+   if (Lines.empty() == false)
+      Request = VectorizeString(APT::String::Strip(Lines[0]), ' ');
+   if (Request.size() != 3)
+   {
+      Client.Close = true;
+      return SendHeader(Client, "400 Bad Request");
+   }
+   std::string const &Method = Request[0];
+   std::string const &URI = Request[1];
+   Client.Close = Request[2] == "HTTP/1.0";
+   Client.IfModifiedSince = 0;
+   for (auto L = Lines.begin() + 1; L != Lines.end(); ++L)
+   {
+      auto const Colon = L->find(':');
+      if (Colon == std::string::npos)
+	 continue;
+      std::string const Tag = L->substr(0, Colon);
+      std::string const Value = APT::String::Strip(L->substr(Colon + 1));
+      if (strcasecmp(Tag.c_str(), "Connection") == 0)
+	 Client.Close = strcasecmp(Value.c_str(), "close") == 0;
+      else if (strcasecmp(Tag.c_str(), "If-Modified-Since") == 0 &&
+	       RFC1123StrToTime(Value, Client.IfModifiedSince) == false)
+	 Client.IfModifiedSince = 0;
+   }
+
+   Client.HeadOnly = Method == "HEAD";
+   if (Method != "GET" && Method != "HEAD")
+      return SendHeader(Client, "501 Not Implemented");
+   if (APT::String::Startswith(URI, "http://") == false)
+      return SendHeader(Client, "400 Bad Request");
+   if (IsUpstreamAllowed(URI) == false)
+      return SendHeader(Client, "403 Forbidden");
+
+   HashStringList Hashes;
+   auto const Policy = Classify(URI, Hashes);
+   std::string const Final = CacheFilename(URI);
+   if (IsCacheValid(Final, Policy, Hashes))
+      return SendFile(Client, Final);
+   StartFetch(ID, URI, Final, Policy, Hashes);
+}
+									/*}}}*/
+// CacheProxy::Progress - continue with the next request of a client	/*{{{*/
+void CacheProxy::Progress(unsigned long const ID)
+{
+   auto C = Clients.find(ID);
+   while (C != Clients.end())
+   {
+      auto &Client = C->second;
+      if (Client.Waiting || Client.Out.empty() == false || Client.Remaining != 0)
+	 return;
+      if (Client.Close)
+      {
+	 close(Client.Fd);
+	 Clients.erase(C);
+	 return;
+      }
+      if (Client.In.find("\r\n\r\n") == std::string::npos && Client.In.length() <= MaxRequestSize)
+	 return;
+      HandleRequest(ID, Client);
+      C = Clients.find(ID);
+   }
+}
+									/*}}}*/
+// CacheProxy::Accept - add a new client				/*{{{*/
+void CacheProxy::Accept(int const ListenFd)
+{
+   int const Fd = accept(ListenFd, nullptr, nullptr);
+   if (Fd == -1)
+   {
+      if (errno != EINTR && errno != EAGAIN)
+      {
+	 _error->Errno("accept", "Couldn't accept client on socket %d", ListenFd);
+	 _error->DumpErrors(std::cerr);
+      }
+      return;
+   }
+   SetNonBlock(Fd, true);
+   SetCloseExec(Fd, true);
+   Clients.emplace(std::piecewise_construct, std::forward_as_tuple(++NextClient), std::forward_as_tuple(Fd));
+}
+									/*}}}*/
+// CacheProxy::Read - receive (parts of) requests			/*{{{*/
+/* Returns false if the client is gone or sends more than we are willing
+   to buffer while it waits for an answer. */
+bool CacheProxy::Read(ProxyClient &Client)
+{
+   char Buffer[4096];
+   ssize_t const Res = read(Client.Fd, Buffer, sizeof(Buffer));
+   if (Res > 0)
+   {
+      Client.In.append(Buffer, Res);
+      bool const Busy = Client.Waiting || Client.Out.empty() == false || Client.Remaining != 0;
+      return Busy == false || Client.In.length() <= MaxRequestSize;
+   }
+   return Res != 0 && (errno == EINTR || errno == EAGAIN);
+}
+									/*}}}*/
+// CacheProxy::Write - send (parts of) the response			/*{{{*/
+bool CacheProxy::Write(ProxyClient &Client)
+{
+   if (Client.Out.empty() && Client.Remaining != 0)
+   {
+      char Buffer[64 * 1024];
+      unsigned long long Actual = 0;
+      if (Client.File.Read(Buffer, std::min<unsigned long long>(sizeof(Buffer), Client.Remaining), &Actual) == false || Actual == 0)
+      {
+	 _error->DumpErrors(std::cerr);
+	 return false;
+      }
+      Client.Out.append(Buffer, Actual);
+      Client.Remaining -= Actual;
+      if (Client.Remaining == 0)
+	 Client.File.Close();
+   }
+   if (Client.Out.empty())
+      return true;
+   ssize_t const Res = write(Client.Fd, Client.Out.data(), Client.Out.length());
+   if (Res > 0)
+      Client.Out.erase(0, Res);
+   return Res > 0 || errno == EINTR || errno == EAGAIN;
+}
+									/*}}}*/
+// CacheProxy::Drop - forget a client which is gone			/*{{{*/
+/* A fetch it waits for is finished nonetheless to fill the cache. */
+void CacheProxy::Drop(unsigned long const ID)
+{
+   for (auto &F : Fetches)
+   {
+      auto &Waiting = F.second.Clients;
+      Waiting.erase(std::remove(Waiting.begin(), Waiting.end(), ID), Waiting.end());
+   }
+   auto const C = Clients.find(ID);
+   close(C->second.Fd);
+   Clients.erase(C);
+}
+									/*}}}*/
+// CacheProxy::Run - the event loop					/*{{{*/
+bool CacheProxy::Run()
+{
+   std::vector<struct pollfd> Fds;
+   std::vector<unsigned long> IDs;
+   while (true)
+   {
+      Fds.clear();
+      IDs.clear();
+      for (auto const L : Listen)
+	 Fds.push_back({L, POLLIN, 0});
+      for (auto const &F : Fetches)
+	 Fds.push_back({F.first, POLLIN, 0});
+      size_t const NumFetches = Fetches.size();
+      for (auto const &C : Clients)
+      {
+	 short Events = POLLIN;
+	 if (C.second.Out.empty() == false || C.second.Remaining != 0)
+	    Events |= POLLOUT;
+	 Fds.push_back({C.second.Fd, Events, 0});
+	 IDs.push_back(C.first);
+      }
+
+      if (poll(Fds.data(), Fds.size(), -1) < 0)
+      {
+	 if (errno == EINTR)
+	    continue;
+	 return _error->Errno("poll", "Waiting for clients failed");
+      }
+
+      /* finishing a fetch answers clients, which can start new fetches,
+	 so the fetches polled are not necessarily those in the map now */
+      size_t const FirstClient = Listen.size() + NumFetches;
+      for (size_t I = Listen.size(); I < FirstClient; ++I)
+      {
+	 if (Fds[I].revents == 0)
+	    continue;
+	 auto const F = Fetches.find(Fds[I].fd);
+	 if (F == Fetches.end())
+	    continue;
+	 char Buffer[1024];
+	 ssize_t const Res = read(Fds[I].fd, Buffer, sizeof(Buffer));
+	 if (Res > 0)
+	    F->second.Result.append(Buffer, Res);
+	 else if (Res == 0 || errno != EINTR)
+	    FinishFetch(Fds[I].fd);
+      }
+      for (size_t I = 0; I < IDs.size(); ++I)
+      {
+	 auto const ID = IDs[I];
+	 auto const &P = Fds[FirstClient + I];
+	 auto C = Clients.find(ID);
+	 if (C == Clients.end() || P.revents == 0)
+	    continue;
+	 if (((P.revents & (POLLIN | POLLHUP | POLLERR)) && Read(C->second) == false) ||
+	     ((P.revents & POLLOUT) && Write(C->second) == false))
+	 {
+	    Drop(ID);
+	    continue;
+	 }
+	 Progress(ID);
+      }
+      for (size_t I = 0; I < Listen.size(); ++I)
+	 if (Fds[I].revents & POLLIN)
+	    Accept(Fds[I].fd);
+   }
+   return true;
+}
+									/*}}}*/
+// DoCacheProxy - run a caching proxy for APT repositories		/*{{{*/
+bool DoCacheProxy(CommandLine &CmdL)
+{
+   if (CmdL.FileSize() != 1)
+      return _error->Error(_("This command takes no arguments"));
+
+   _config->CndSet("Dir::Cache::Proxy", "proxy/");
+   std::string const Directory = _config->FindDir("Dir::Cache::Proxy");
+   std::string const Partial = Directory + "partial";
+   if (CreateAPTDirectoryIfNeeded(_config->FindDir("Dir::Cache"), Partial) == false &&
+       CreateAPTDirectoryIfNeeded(Directory, Partial) == false)
+      return _error->Errno("mkdir", _("Archives directory %s is missing."), Partial.c_str());
+   // the downloads are done by the sandboxed methods
+   ChangeOwnerAndPermissionOfFile("DoCacheProxy", Partial.c_str(), _config->Find("APT::Sandbox::User").c_str(), ROOT_GROUP, 0700);
+   if (_config->FindB("Debug::NoLocking", false) == false && GetLock(flCombine(Directory, "lock")) == -1)
+      return _error->Error(_("Unable to lock directory %s"), Directory.c_str());
+
+   // clients can close the connection at any time
+   signal(SIGPIPE, SIG_IGN);
+
+   /* Anyone able to connect can make us fetch arbitrary http URIs, so we
+      only listen on the loopback interface by default */
+   std::string const Address = _config->Find("APT::Cache-Proxy::Address", "localhost");
+   int Port = _config->FindI("APT::Cache-Proxy::Port", 3142);
+   struct addrinfo Hints;
+   memset(&Hints, 0, sizeof(Hints));
+   Hints.ai_family = AF_UNSPEC;
+   Hints.ai_socktype = SOCK_STREAM;
+   Hints.ai_flags = AI_PASSIVE;
+   struct addrinfo *Addrs = nullptr;
+   int const Res = getaddrinfo(Address == "*" ? nullptr : Address.c_str(), std::to_string(Port).c_str(), &Hints, &Addrs);
+   if (Res != 0)
+      return _error->Error(_("Could not resolve '%s'"), Address.c_str());
+
+   std::vector<int> Listen;
+   for (auto A = Addrs; A != nullptr; A = A->ai_next)
+   {
+      int const Fd = socket(A->ai_family, A->ai_socktype, A->ai_protocol);
+      if (Fd < 0)
+	 continue;
+      int const Enable = 1;
+      setsockopt(Fd, SOL_SOCKET, SO_REUSEADDR, &Enable, sizeof(Enable));
+      // the IPv4 wildcard gets a socket of its own
+      if (A->ai_family == AF_INET6)
+	 setsockopt(Fd, IPPROTO_IPV6, IPV6_V6ONLY, &Enable, sizeof(Enable));
+      // if a free port was picked, all addresses have to agree on it
+      if (A->ai_family == AF_INET6)
+	 reinterpret_cast<struct sockaddr_in6 *>(A->ai_addr)->sin6_port = htons(Port);
+      else if (A->ai_family == AF_INET)
+	 reinterpret_cast<struct sockaddr_in *>(A->ai_addr)->sin_port = htons(Port);
+      struct sockaddr_storage Bound;
+      socklen_t BoundLen = sizeof(Bound);
+      if (bind(Fd, A->ai_addr, A->ai_addrlen) != 0 ||
+	  getsockname(Fd, reinterpret_cast<struct sockaddr *>(&Bound), &BoundLen) != 0 ||
+	  listen(Fd, SOMAXCONN) != 0)
+      {
+	 _error->Errno("bind", "Couldn't listen on port %d", Port);
+	 close(Fd);
+	 continue;
+      }
+      if (Bound.ss_family == AF_INET6)
+	 Port = ntohs(reinterpret_cast<struct sockaddr_in6 *>(&Bound)->sin6_port);
+      else if (Bound.ss_family == AF_INET)
+	 Port = ntohs(reinterpret_cast<struct sockaddr_in *>(&Bound)->sin_port);
+      SetNonBlock(Fd, true);
+      SetCloseExec(Fd, true);
+      Listen.push_back(Fd);
+   }
+   freeaddrinfo(Addrs);
+   if (Listen.empty())
+      return false;
+   // e.g. localhost might resolve to ::1 on a system without IPv6
+   _error->Discard();
+
+   ioprintf(std::cout, "Listening on port %d\n", Port);
+   std::cout.flush();
+
+   CacheProxy Proxy(Directory, std::move(Listen));
+   return Proxy.Run();
+}
+									/*}}}*/
@@ -0,0 +1,10 @@
+#ifndef APT_PRIVATE_CACHE_PROXY_H
+#define APT_PRIVATE_CACHE_PROXY_H
+
+#include <apt-pkg/macros.h>
+
+class CommandLine;
+
+APT_PUBLIC bool DoCacheProxy(CommandLine &CmdL);
+
+#endif
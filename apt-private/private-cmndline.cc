@@ -75,8 +75,12 @@ static bool addArgumentsAPTCache(std::vector<CommandLine::Args> &Args, char cons
    {
       addArg(0,"only-source","APT::Cache::Only-Source",0);
    }
+   else if (CmdMatches("dumpavail"))
+   {
+      addArg(0, "format", "APT::Cache::DumpAvail::Format", CommandLine::HasArg);
+   }
    else if (CmdMatches("gencaches", "showpkg", "stats", "dump",
-	    "dumpavail", "showauto", "policy", "madison"))
+	    "showauto", "policy", "madison"))
       ;
    else
       return false;
@@ -343,6 +347,7 @@ static bool addArgumentsAPT(std::vector<CommandLine::Args> &Args, char const * c
       addArg(0,"manual-installed","APT::Cmd::Manual-Installed",0);
       addArg('v', "verbose", "APT::Cmd::List-Include-Summary", 0);
       addArg('a', "all-versions", "APT::Cmd::All-Versions", 0);
+      addArg(0, "format", "APT::Cmd::List-Format", CommandLine::HasArg);
    }
    else if (CmdMatches("show") || CmdMatches("info"))
    {
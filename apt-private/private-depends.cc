@@ -21,6 +21,39 @@
 #include <apti18n.h>
 									/*}}}*/
 
+// PackageGraphWalk - Breadth-first walk over packages			/*{{{*/
+PackageGraphWalk::PackageGraphWalk(pkgCache &Cache) : Seen(Cache.Head().PackageCount, false)
+{
+}
+bool PackageGraphWalk::See(pkgCache::PkgIterator const &Pkg)
+{
+   if (Seen[Pkg->ID] == true)
+      return false;
+   Seen[Pkg->ID] = true;
+   return true;
+}
+bool PackageGraphWalk::Push(pkgCache::PkgIterator const &Pkg)
+{
+   if (See(Pkg) == false)
+      return false;
+   Frontier.push_back(Pkg);
+   return true;
+}
+void PackageGraphWalk::PushAgain(pkgCache::PkgIterator const &Pkg)
+{
+   Seen[Pkg->ID] = true;
+   Frontier.push_back(Pkg);
+}
+void PackageGraphWalk::Run(std::function<void(pkgCache::PkgIterator const &)> const &Visit)
+{
+   while (Frontier.empty() == false)
+   {
+      pkgCache::PkgIterator const Pkg = Frontier.front();
+      Frontier.pop_front();
+      Visit(Pkg);
+   }
+}
+									/*}}}*/
 // ShowDepends - Helper for printing out a dependency tree		/*{{{*/
 static bool ShowDepends(CommandLine &CmdL, bool const RevDepends)
 {
@@ -33,7 +66,6 @@ static bool ShowDepends(CommandLine &CmdL, bool const RevDepends)
    APT::VersionList verset = APT::VersionList::FromCommandLine(CacheFile, CmdL.FileList + 1, APT::CacheSetHelper::CANDIDATE, helper);
    if (verset.empty() == true && helper.virtualPkgs.empty() == true)
       return _error->Error(_("No packages found"));
-   std::vector<bool> Shown(Cache->Head().PackageCount);
 
    bool const Recurse = _config->FindB("APT::Cache::RecurseDepends", false);
    bool const Installed = _config->FindB("APT::Cache::Installed", false);
@@ -51,17 +83,14 @@ static bool ShowDepends(CommandLine &CmdL, bool const RevDepends)
    bool const ShowOnlyFirstOr = _config->FindB("APT::Cache::ShowOnlyFirstOr", false);
    bool const ShowImplicit = _config->FindB("APT::Cache::ShowImplicit", false);
 
-   while (verset.empty() != true)
-   {
-      pkgCache::VerIterator Ver = *verset.begin();
-      verset.erase(verset.begin());
+   PackageGraphWalk Walk(*Cache);
+   auto const Display = [&](pkgCache::VerIterator const &Ver) {
       pkgCache::PkgIterator Pkg = Ver.ParentPkg();
-      Shown[Pkg->ID] = true;
 
-      std::cout << Pkg.FullName(true) << std::endl;
+      std::cout << Pkg.FullName(true) << '\n';
 
       if (RevDepends == true)
-	 std::cout << "Reverse Depends:" << std::endl;
+	 std::cout << "Reverse Depends:" << '\n';
       for (pkgCache::DepIterator D = RevDepends ? Pkg.RevDependsList() : Ver.DependsList();
 	    D.end() == false; ++D)
       {
@@ -97,13 +126,10 @@ static bool ShowDepends(CommandLine &CmdL, bool const RevDepends)
 	       std::cout << Trg.FullName(true);
 	    if (ShowVersion == true && D->Version != 0)
 	       std::cout << " (" << pkgCache::CompTypeDeb(D->CompareOp) << ' ' << D.TargetVer() << ')';
-	    std::cout << std::endl;
+	    std::cout << '\n';
 
-	    if (Recurse == true && Shown[Trg->ID] == false)
-	    {
-	       Shown[Trg->ID] = true;
-	       verset.insert(APT::VersionSet::FromPackage(CacheFile, Trg, APT::CacheSetHelper::CANDIDATE, helper));
-	    }
+	    if (Recurse == true)
+	       Walk.Push(Trg);
 
 	    // Display all solutions
 	    std::unique_ptr<pkgCache::Version *[]> List(D.AllTargets());
@@ -114,13 +140,10 @@ static bool ShowDepends(CommandLine &CmdL, bool const RevDepends)
 	       if (V != Cache->VerP + V.ParentPkg()->VersionList ||
 		   V->ParentPkg == D->Package)
 		  continue;
-	       std::cout << "    " << V.ParentPkg().FullName(true) << std::endl;
+	       std::cout << "    " << V.ParentPkg().FullName(true) << '\n';
 
-	       if (Recurse == true && Shown[V.ParentPkg()->ID] == false)
-	       {
-		  Shown[V.ParentPkg()->ID] = true;
-		  verset.insert(APT::VersionSet::FromPackage(CacheFile, V.ParentPkg(), APT::CacheSetHelper::CANDIDATE, helper));
-	       }
+	       if (Recurse == true)
+		  Walk.Push(V.ParentPkg());
 	    }
 
 	 }
@@ -128,12 +151,23 @@ static bool ShowDepends(CommandLine &CmdL, bool const RevDepends)
 	 if (ShowOnlyFirstOr == true)
 	    while ((D->CompareOp & pkgCache::Dep::Or) == pkgCache::Dep::Or) ++D;
       }
-   }
+   };
+
+   // the packages given are shown first, the ones reached from them after
+   for (auto const &Ver : verset)
+      Walk.See(Ver.ParentPkg());
+   for (auto const &Ver : verset)
+      Display(Ver);
+   Walk.Run([&](pkgCache::PkgIterator const &Pkg) {
+      for (auto const &Ver : APT::VersionSet::FromPackage(CacheFile, Pkg, APT::CacheSetHelper::CANDIDATE, helper))
+	 Display(Ver);
+   });
 
    for (APT::PackageSet::const_iterator Pkg = helper.virtualPkgs.begin();
 	 Pkg != helper.virtualPkgs.end(); ++Pkg)
-      std::cout << '<' << Pkg.FullName(true) << '>' << std::endl;
+      std::cout << '<' << Pkg.FullName(true) << '>' << '\n';
 
+   std::cout.flush();
    return true;
 }
 									/*}}}*/
@@ -2,9 +2,41 @@
 #define APT_PRIVATE_DEPENDS_H
 
 #include <apt-pkg/macros.h>
+#include <apt-pkg/pkgcache.h>
+
+#include <deque>
+#include <functional>
+#include <vector>
 
 class CommandLine;
 
+/** \brief breadth-first walk over the packages of a dependency graph
+ *
+ * The walk keeps a frontier of packages still to visit and a bitset of
+ * packages seen so far, so each package is expanded only once however
+ * often it is reached, and nothing else is scanned to find the next one.
+ */
+class APT_PUBLIC PackageGraphWalk
+{
+   std::vector<bool> Seen;
+   std::deque<pkgCache::PkgIterator> Frontier;
+
+   public:
+   explicit PackageGraphWalk(pkgCache &Cache);
+
+   /** \brief mark a package as seen without visiting it
+    * \return \b true if the package was not seen before */
+   bool See(pkgCache::PkgIterator const &Pkg);
+   /** \brief add a package to the frontier unless it was seen before */
+   bool Push(pkgCache::PkgIterator const &Pkg);
+   /** \brief add a package to the frontier even if it was seen before,
+    * e.g. as it has to be expanded further than on its first visit */
+   void PushAgain(pkgCache::PkgIterator const &Pkg);
+   /** \brief visit the packages in the order they were added until the
+    * frontier is empty; the visitor can push more packages */
+   void Run(std::function<void(pkgCache::PkgIterator const &)> const &Visit);
+};
+
 APT_PUBLIC bool Depends(CommandLine &CmdL);
 APT_PUBLIC bool RDepends(CommandLine &CmdL);
 
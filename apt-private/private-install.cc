@@ -25,9 +25,14 @@
 #include <iostream>
 #include <map>
 #include <set>
+#include <sstream>
 #include <vector>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <apt-private/acqprogress.h>
 #include <apt-private/private-cachefile.h>
@@ -100,6 +105,174 @@ static void RemoveDownloadNeedingItemsFromFetcher(pkgAcquire &Fetcher, bool &Tra
       I = Fetcher.ItemsBegin();
    }
 }
+class APT_HIDDEN AcqBackgroundStatus : public AcqTextStatus
+{
+   std::ostringstream &Log;
+   int const LogFd;
+   int const NotifyFd;
+
+   public:
+   /* dpkg might be running, so the messages are handed to the parent
+      which shows them the next time it isn't */
+   void Flush()
+   {
+      std::string const Text = Log.str();
+      Log.str("");
+      FileFd::Write(LogFd, Text.data(), Text.size());
+   }
+   virtual bool MediaChange(std::string, std::string) APT_OVERRIDE
+   {
+      return false;
+   }
+   virtual void IMSHit(pkgAcquire::ItemDesc &Itm) APT_OVERRIDE
+   {
+      AcqTextStatus::IMSHit(Itm);
+      Flush();
+   }
+   virtual void Fetch(pkgAcquire::ItemDesc &Itm) APT_OVERRIDE
+   {
+      AcqTextStatus::Fetch(Itm);
+      Flush();
+   }
+   virtual void Fail(pkgAcquire::ItemDesc &Itm) APT_OVERRIDE
+   {
+      AcqTextStatus::Fail(Itm);
+      Flush();
+   }
+   virtual void Stop() APT_OVERRIDE
+   {
+      AcqTextStatus::Stop();
+      Flush();
+   }
+   virtual void Done(pkgAcquire::ItemDesc &Itm) APT_OVERRIDE
+   {
+      AcqTextStatus::Done(Itm);
+      Flush();
+      char const Ready = '.';
+      FileFd::Write(NotifyFd, &Ready, sizeof(Ready));
+   }
+   // no progress bar as it would fight with the one of dpkg
+   AcqBackgroundStatus(std::ostringstream &Log, int const LogFd, int const NotifyFd) :
+      AcqTextStatus(Log, ::ScreenWidth, std::max(1, _config->FindI("quiet", 0))),
+      Log(Log), LogFd(LogFd), NotifyFd(NotifyFd) {}
+};
+// show what the download child has logged since the last call
+static void ShowBackgroundLog(int const LogFd, off_t &Offset)
+{
+   char Buffer[4096];
+   ssize_t Res;
+   while ((Res = pread(LogFd, Buffer, sizeof(Buffer), Offset)) > 0 || (Res < 0 && errno == EINTR))
+   {
+      if (Res < 0)
+	 continue;
+      std::cout.write(Buffer, Res);
+      Offset += Res;
+   }
+   std::cout.flush();
+}
+/* Installs the archives which are already available while the others are
+   still downloaded by a child process, so that the time spent on the network
+   and the time spent in dpkg overlap. Each time new archives have arrived
+   the next batch in install order is handed to dpkg. After the download is
+   finished the Fetcher is refilled with whatever is still left to do, which
+   includes the retry of failed downloads. */
+static bool InstallWhileDownloading(pkgAcquire &Fetcher, pkgPackageManager &PM,
+      pkgSourceList * const List, pkgRecords &Recs,
+      std::vector<std::string> &Archives, bool &Completed)
+{
+   std::string const archivedir = _config->FindDir("Dir::Cache::archives");
+   for (auto I = Fetcher.ItemsBegin(); I != Fetcher.ItemsEnd(); ++I)
+      if ((*I)->Local == false)
+	 Archives.push_back(archivedir + flNotDir((*I)->DestFile));
+
+   // the child appends to the log, the parent reads it at its own offset
+   FileFd LogFile;
+   if (GetTempFile("apt-download-log", true, &LogFile) == nullptr)
+      return false;
+   int const LogFd = LogFile.Fd();
+   if (fcntl(LogFd, F_SETFL, fcntl(LogFd, F_GETFL) | O_APPEND) != 0)
+      return _error->Errno("fcntl", "Failed to set O_APPEND on %s", LogFile.Name().c_str());
+   off_t LogOffset = 0;
+
+   int Pipe[2];
+   if (pipe(Pipe) != 0)
+      return _error->Errno("pipe", "Failed to create IPC pipe to subprocess");
+   std::cout.flush();
+   std::cerr.flush();
+   pid_t const Child = ExecFork({Pipe[1], LogFd});
+   if (Child == 0)
+   {
+      std::ostringstream Log;
+      AcqBackgroundStatus Stat(Log, LogFd, Pipe[1]);
+      Fetcher.SetLog(&Stat);
+      bool Failed = Fetcher.Run() != pkgAcquire::Continue;
+      for (auto I = Fetcher.ItemsBegin(); I != Fetcher.ItemsEnd(); ++I)
+	 if ((*I)->Status != pkgAcquire::Item::StatDone || (*I)->Complete == false)
+	    Failed = true;
+      _error->DumpErrors(Log);
+      Stat.Flush();
+      _exit(Failed ? 100 : 0);
+   }
+   close(Pipe[1]);
+
+   PM.SetWaitForMissing(true);
+   bool Okay = true;
+   bool Downloading = true;
+   while (Downloading == true)
+   {
+      // wait for at least one new archive, the rest arrives while dpkg works
+      char Buffer[1024];
+      ssize_t Res;
+      do
+	 Res = read(Pipe[0], Buffer, sizeof(Buffer));
+      while (Res < 0 && errno == EINTR);
+      Downloading = Res > 0;
+      ShowBackgroundLog(LogFd, LogOffset);
+
+      Fetcher.Shutdown();
+      if (PM.GetArchives(&Fetcher, List, &Recs) == false)
+      {
+	 Okay = false;
+	 break;
+      }
+      // forget about the archives which are not available yet
+      for (auto I = Fetcher.ItemsBegin(); I != Fetcher.ItemsEnd(); ++I)
+	 (*I)->Finished();
+
+      auto const progress = APT::Progress::PackageManagerProgressFactory();
+      _system->UnLockInner();
+      pkgPackageManager::OrderResult const Result = PM.DoInstall(progress);
+      delete progress;
+
+      if (Result == pkgPackageManager::Failed || _error->PendingError() == true)
+      {
+	 Okay = false;
+	 break;
+      }
+      if (Result == pkgPackageManager::Completed)
+      {
+	 Completed = true;
+	 break;
+      }
+      _system->LockInner();
+   }
+   PM.SetWaitForMissing(false);
+
+   if (Okay == false)
+      kill(Child, SIGTERM);
+   close(Pipe[0]);
+   ExecWait(Child, "download", true);
+   ShowBackgroundLog(LogFd, LogOffset);
+   if (Okay == false)
+      return false;
+
+   if (Completed == false)
+   {
+      Fetcher.Shutdown();
+      return PM.GetArchives(&Fetcher, List, &Recs);
+   }
+   return true;
+}
 bool InstallPackages(CacheFile &Cache,bool ShwKept,bool Ask, bool Safety)
 {
    if (not RunScripts("APT::Install::Pre-Invoke"))
@@ -319,7 +492,17 @@ bool InstallPackages(CacheFile &Cache,bool ShwKept,bool Ask, bool Safety)
 
    // Run it
    bool Failed = false;
-   while (1)
+   bool Completed = false;
+   std::vector<std::string> BackgroundArchives;
+   if (_config->FindB("APT::Install::Download-While-Installing", false) == true &&
+       _config->FindB("APT::Get::Download-Only", false) == false &&
+       DownloadAllowed == true && Fetcher.FetchNeeded() != 0 &&
+       _config->Find("APT::Planner", "internal") == "internal")
+   {
+      if (InstallWhileDownloading(Fetcher, *PM, List, Recs, BackgroundArchives, Completed) == false)
+	 return false;
+   }
+   while (Completed == false)
    {
       bool Transient = false;
       if (AcquireRun(Fetcher, 0, &Failed, &Transient) == false)
@@ -391,6 +574,8 @@ bool InstallPackages(CacheFile &Cache,bool ShwKept,bool Ask, bool Safety)
 	    continue;
          RemoveFile("Keep-Downloaded-Packages=false", (*I)->DestFile);
       }
+      for (auto const &archive : BackgroundArchives)
+	 RemoveFile("Keep-Downloaded-Packages=false", archive);
    }
 
    if (not RunScripts("APT::Install::Post-Invoke-Success"))
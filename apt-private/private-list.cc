@@ -6,6 +6,8 @@
 #include <apt-pkg/cacheset.h>
 #include <apt-pkg/cmndline.h>
 #include <apt-pkg/configuration.h>
+#include <apt-pkg/error.h>
+#include <apt-pkg/fileutl.h>
 #include <apt-pkg/macros.h>
 #include <apt-pkg/pkgcache.h>
 #include <apt-pkg/pkgrecords.h>
@@ -16,13 +18,18 @@
 #include <apt-private/private-list.h>
 #include <apt-private/private-output.h>
 
+#include <algorithm>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include <string.h>
+#include <unistd.h>
+
 #include <apti18n.h>
 									/*}}}*/
 
@@ -97,6 +104,50 @@ static void ListAllVersions(pkgCacheFile &CacheFile, pkgRecords &records,/*{{{*/
    }
 }
 									/*}}}*/
+static bool ListMachineReadable(pkgCacheFile &CacheFile, Matcher &matcher, bool const Json)/*{{{*/
+{
+   std::unique_ptr<pkgRecords> records;
+   if (_config->FindB("APT::Cmd::List-Include-Summary", false) == true)
+      records.reset(new pkgRecords(CacheFile));
+
+   LocalitySortedVersionSet bag;
+   OpProgress progress;
+   GetLocalitySortedVersionSet(CacheFile, &bag, matcher, &progress);
+   if (_error->PendingError() == true)
+      return false;
+
+   // sort by name instead of formatting everything into a sorted map
+   std::vector<pkgCache::VerIterator> versions(bag.begin(), bag.end());
+   std::sort(versions.begin(), versions.end(), [](pkgCache::VerIterator const &A, pkgCache::VerIterator const &B) {
+      int const Res = strcmp(A.ParentPkg().Name(), B.ParentPkg().Name());
+      if (Res != 0)
+	 return Res < 0;
+      return strcmp(A.ParentPkg().Arch(), B.ParentPkg().Arch()) < 0;
+   });
+
+   std::cout.flush();
+   FileFd out;
+   if (out.OpenDescriptor(STDOUT_FILENO, FileFd::WriteOnly | FileFd::BufferedWrite, false) == false)
+      return false;
+
+   bool const ShowAllVersions = _config->FindB("APT::Cmd::All-Versions", false);
+   std::string record;
+   for (auto const &V : versions)
+   {
+      pkgCache::VerIterator Ver = ShowAllVersions ? V.ParentPkg().VersionList() : V;
+      for (; Ver.end() == false; ++Ver)
+      {
+	 record.clear();
+	 WriteVersionRecord(CacheFile, records.get(), Ver, record, Json);
+	 if (out.Write(record.data(), record.size()) == false)
+	    return false;
+	 if (ShowAllVersions == false)
+	    break;
+      }
+   }
+   return out.Close();
+}
+									/*}}}*/
 // list - list package based on criteria        			/*{{{*/
 // ---------------------------------------------------------------------
 bool DoList(CommandLine &Cmd)
@@ -105,7 +156,6 @@ bool DoList(CommandLine &Cmd)
    pkgCache * const Cache = CacheFile.GetPkgCache();
    if (unlikely(Cache == nullptr || CacheFile.GetDepCache() == nullptr))
       return false;
-   pkgRecords records(CacheFile);
 
    const char **patterns;
    const char *all_pattern[] = { "*", NULL};
@@ -117,11 +167,18 @@ bool DoList(CommandLine &Cmd)
       patterns = Cmd.FileList + 1;
    }
 
+   PackageNameMatcher matcher(CacheFile, patterns);
+   std::string const OutputFormat = _config->Find("APT::Cmd::List-Format", "text");
+   if (OutputFormat == "json" || OutputFormat == "deb822")
+      return ListMachineReadable(CacheFile, matcher, OutputFormat == "json");
+   else if (OutputFormat != "text")
+      return _error->Error(_("Unknown output format '%s'"), OutputFormat.c_str());
+
+   pkgRecords records(CacheFile);
    std::string format = "${color:highlight}${Package}${color:neutral}/${Origin} ${Version} ${Architecture}${ }${apt:Status}";
    if (_config->FindB("APT::Cmd::List-Include-Summary", false) == true)
       format += "\n  ${Description}\n";
 
-   PackageNameMatcher matcher(CacheFile, patterns);
    LocalitySortedVersionSet bag;
    OpTextProgress progress(*_config);
    progress.OverallProgress(0,
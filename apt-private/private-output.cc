@@ -316,6 +316,160 @@ void ListSingleVersion(pkgCacheFile &CacheFile, pkgRecords &records,	/*{{{*/
    out << output;
 }
 									/*}}}*/
+// AppendJsonString - Append a quoted and escaped JSON string		/*{{{*/
+void AppendJsonString(std::string &out, APT::StringView const str)
+{
+   out.push_back('"');
+   for (char const c : str)
+   {
+      switch (c)
+      {
+      case '"': out.append("\\\""); break;
+      case '\\': out.append("\\\\"); break;
+      case '\n': out.append("\\n"); break;
+      case '\t': out.append("\\t"); break;
+      default:
+	 if (static_cast<unsigned char>(c) < 0x20)
+	 {
+	    char buf[7];
+	    snprintf(buf, sizeof(buf), "\\u%04x", c);
+	    out.append(buf);
+	 }
+	 else
+	    out.push_back(c);
+      }
+   }
+   out.push_back('"');
+}
+									/*}}}*/
+// RecordWriter - Fields of a JSON object or a deb822 stanza		/*{{{*/
+// ---------------------------------------------------------------------
+/* Appends everything to the buffer given by the caller, so that writing
+   a record needs no allocations once the buffer reached its size. */
+class APT_HIDDEN RecordWriter
+{
+   std::string &out;
+   bool const Json;
+   bool First = true;
+   char const *ListName = nullptr;
+   bool ListEmpty = true;
+
+   void name(char const * const Name)
+   {
+      if (Json)
+      {
+	 out.push_back(First ? '{' : ',');
+	 AppendJsonString(out, Name);
+	 out.push_back(':');
+      }
+      else
+	 out.append(Name).append(":");
+      First = false;
+   }
+
+   public:
+   RecordWriter(std::string &out, bool const Json) : out(out), Json(Json) {}
+   void field(char const * const Name, APT::StringView const Value)
+   {
+      name(Name);
+      if (Json)
+	 AppendJsonString(out, Value);
+      else
+	 out.append(" ").append(Value.data(), Value.size()).append("\n");
+   }
+   void beginList(char const * const Name)
+   {
+      ListName = Name;
+      ListEmpty = true;
+      // deb822 has no empty lists, so the field is only written with an item
+      if (Json)
+      {
+	 name(Name);
+	 out.push_back('[');
+      }
+   }
+   void item(APT::StringView const Value)
+   {
+      if (Json)
+      {
+	 if (ListEmpty == false)
+	    out.push_back(',');
+	 AppendJsonString(out, Value);
+      }
+      else
+      {
+	 if (ListEmpty)
+	    name(ListName);
+	 else
+	    out.push_back(',');
+	 out.append(" ").append(Value.data(), Value.size());
+      }
+      ListEmpty = false;
+   }
+   void endList()
+   {
+      if (Json)
+	 out.push_back(']');
+      else if (ListEmpty == false)
+	 out.push_back('\n');
+   }
+   void finish()
+   {
+      if (Json)
+	 out.append(First ? "{}\n" : "}\n");
+      else
+	 out.push_back('\n');
+   }
+};
+									/*}}}*/
+// WriteVersionRecord - Machine-readable description of a version	/*{{{*/
+void WriteVersionRecord(pkgCacheFile &CacheFile, pkgRecords * const records,
+			pkgCache::VerIterator const &V, std::string &out, bool const Json)
+{
+   pkgCache::PkgIterator const P = V.ParentPkg();
+   pkgDepCache::StateCache const &state = (*CacheFile.GetDepCache())[P];
+
+   RecordWriter writer(out, Json);
+   writer.field("Package", P.Name());
+   writer.field("Architecture", V.Arch());
+   writer.field("Version", V.VerStr());
+   writer.beginList("Suites");
+   for (pkgCache::VerFileIterator VF = V.FileList(); VF.end() == false; ++VF)
+      writer.item(VF.File().Archive() == nullptr ? "unknown" : VF.File().Archive());
+   writer.endList();
+   if (P->CurrentVer != 0)
+      writer.field("Installed-Version", P.CurrentVer().VerStr());
+   if (state.CandidateVer != nullptr)
+      writer.field("Candidate-Version", pkgCache::VerIterator(CacheFile, state.CandidateVer).VerStr());
+
+   writer.beginList("Status");
+   if (P.CurrentVer() == V)
+   {
+      writer.item("installed");
+      if (state.Upgradable() && state.CandidateVer != nullptr)
+	 writer.item("upgradable");
+      if (V.Downloadable() == false)
+	 writer.item("local");
+      if (V.Automatic() && state.Garbage)
+	 writer.item("auto-removable");
+      if ((state.Flags & pkgCache::Flag::Auto) == pkgCache::Flag::Auto)
+	 writer.item("automatic");
+   }
+   else if (P->CurrentVer != 0 && state.CandidateVer == V && state.Upgradable())
+      writer.item("upgradable");
+   else if (P->CurrentVer == 0 && P->CurrentState == pkgCache::State::ConfigFiles)
+      writer.item("residual-config");
+   writer.endList();
+
+   if (records != nullptr)
+   {
+      pkgCache::DescIterator const Desc = V.TranslatedDescription();
+      if (Desc.end() == false)
+	 writer.field("Description", records->Lookup(Desc.FileList()).ShortDesc());
+   }
+   writer.finish();
+}
+									/*}}}*/
 // ShowBroken - Debugging aide						/*{{{*/
 // ---------------------------------------------------------------------
 /* This prints out the names of all the packages that are broken along
@@ -4,6 +4,7 @@
 #include <apt-pkg/configuration.h>
 #include <apt-pkg/macros.h>
 #include <apt-pkg/pkgcache.h>
+#include <apt-pkg/string_view.h>
 
 #include <fstream>
 #include <functional>
@@ -28,6 +29,9 @@ APT_PUBLIC bool InitOutput(std::basic_streambuf<char> * const out = std::cout.rd
 void ListSingleVersion(pkgCacheFile &CacheFile, pkgRecords &records,
                        pkgCache::VerIterator const &V, std::ostream &out,
                        std::string const &format);
+void WriteVersionRecord(pkgCacheFile &CacheFile, pkgRecords * const records,
+			pkgCache::VerIterator const &V, std::string &out, bool const Json);
+APT_PUBLIC void AppendJsonString(std::string &out, APT::StringView const str);
 
 
 // helper to describe global state
@@ -20,10 +20,12 @@
 #include <apt-private/private-search.h>
 #include <apt-private/private-show.h>
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <string.h>
@@ -91,7 +93,6 @@ static bool FullTextSearch(CommandLine &CmdL)				/*{{{*/
    LocalitySortedVersionSet::iterator V = bag.begin();
 
    progress.OverallProgress(50, 100, 50,  _("Full Text Search"));
-   progress.SubProgress(bag.size());
    pkgRecords records(CacheFile);
 
    std::string format = "${color:highlight}${Package}${color:neutral}/${Origin} ${Version} ${Architecture}${ }${apt:Status}\n";
@@ -101,61 +102,57 @@ static bool FullTextSearch(CommandLine &CmdL)				/*{{{*/
       format += "  ${LongDescription}\n";
 
    bool const NamesOnly = _config->FindB("APT::Cache::NamesOnly", false);
-   int Done = 0;
+   auto const NameMatches = [&](pkgCache::PkgIterator const &P, regex_t const &pattern) {
+      return regexec(&pattern, P.Name(), 0, 0, 0) == 0;
+   };
+
+   /* Read the descriptions in the order they are stored in. A version
+      matches if one of its descriptions matches all patterns its name
+      does not match. */
+   std::vector<bool> DescMatch(Cache->Head().VersionCount, false);
+   if (not NamesOnly)
+   {
+      std::vector<pkgCache::DescFileIterator> DescFiles;
+      std::unordered_multimap<pkgCache::DescFile const *, pkgCache::VerIterator> DescVersions;
+      for (auto const &Ver : bag)
+	 for (auto &Desc: TranslatedDescriptionsList(Ver))
+	 {
+	    DescFiles.push_back(Desc.FileList());
+	    DescVersions.emplace(Desc.FileList(), Ver);
+	 }
+      progress.SubProgress(DescFiles.size());
+      int Done = 0;
+      records.Lookup(std::move(DescFiles), [&](pkgCache::DescFileIterator const &Df, pkgRecords::Parser &parser) {
+	 if (Done%500 == 0)
+	    progress.Progress(Done);
+	 ++Done;
+	 std::string const LongDesc = parser.LongDesc();
+	 auto const Versions = DescVersions.equal_range(Df);
+	 for (auto V = Versions.first; V != Versions.second; ++V)
+	 {
+	    if (DescMatch[V->second->ID] == true)
+	       continue;
+	    pkgCache::PkgIterator const P = V->second.ParentPkg();
+	    DescMatch[V->second->ID] = std::all_of(Patterns.begin(), Patterns.end(), [&](regex_t const &pattern) {
+	       return NameMatches(P, pattern) || regexec(&pattern, LongDesc.c_str(), 0, 0, 0) == 0;
+	    });
+	 }
+	 return true;
+      });
+   }
+
    std::vector<bool> PkgsDone(Cache->Head().PackageCount, false);
    for ( ;V != bag.end(); ++V)
    {
-      if (Done%500 == 0)
-         progress.Progress(Done);
-      ++Done;
-
       // we want to list each package only once
       pkgCache::PkgIterator const P = V.ParentPkg();
       if (PkgsDone[P->ID] == true)
 	 continue;
 
-      std::vector<std::string> PkgDescriptions;
-      if (not NamesOnly)
-      {
-         for (auto &Desc: TranslatedDescriptionsList(V))
-         {
-            pkgRecords::Parser &parser = records.Lookup(Desc.FileList());
-            PkgDescriptions.push_back(parser.LongDesc());
-         }
-      }
-
-      bool all_found = true;
-
+      // search patterns are AND, so one failing fails all
       char const * const PkgName = P.Name();
-      std::vector<bool> SkipDescription(PkgDescriptions.size(), false);
-      for (std::vector<regex_t>::const_iterator pattern = Patterns.begin();
-           pattern != Patterns.end(); ++pattern)
-      {
-         if (regexec(&(*pattern), PkgName, 0, 0, 0) == 0)
-            continue;
-         else if (not NamesOnly)
-         {
-            bool found = false;
-
-            for (std::vector<std::string>::size_type i = 0; i < PkgDescriptions.size(); ++i)
-            {
-               if (not SkipDescription[i])
-               {
-                  if (regexec(&(*pattern), PkgDescriptions[i].c_str(), 0, 0, 0) == 0)
-                     found = true;
-                  else
-                     SkipDescription[i] = true;
-               }
-            }
-
-            if (found)
-               continue;
-         }
-
-         // search patterns are AND, so one failing fails all
-         all_found = false;
-         break;
-      }
+      bool const all_found = DescMatch[V->ID] || std::all_of(Patterns.begin(), Patterns.end(),
+	    [&](regex_t const &pattern) { return NameMatches(P, pattern); });
 
       if (all_found == true)
       {
@@ -200,10 +197,6 @@ static int LocalityCompare(const void * const a, const void * const b)
    return A->File - B->File;
 }
 void LocalitySort(pkgCache::VerFile ** const begin, unsigned long long const Count,size_t const Size)
-{
-   qsort(begin,Count,Size,LocalityCompare);
-}
-static void LocalitySort(pkgCache::DescFile ** const begin, unsigned long long const Count,size_t const Size)
 {
    qsort(begin,Count,Size,LocalityCompare);
 }
@@ -325,79 +318,68 @@ static bool Search(CommandLine &CmdL)
       }
    }
 
-   LocalitySort(&DFList->Df, Cache->HeaderP->GroupCount, sizeof(*DFList));
-
-   // Create the text record parser
+   // Check the descriptions of the candidates in the order they are stored in
    pkgRecords Recs(*Cache);
-   // Iterate over all the version records and check them
-   for (ExDescFile *J = DFList; J->Df != 0; ++J)
+   std::vector<bool> DescMatch(descCount, false);
+   std::unordered_map<pkgCache::DescFile const *, map_id_t> DescGroup;
+   auto const NameMatchedAll = [&](map_id_t const ID) {
+      return std::all_of(PatternMatch + ID * NumPatterns, PatternMatch + (ID + 1) * NumPatterns, [](bool const M) { return M; });
+   };
+   if (NamesOnly == false)
    {
-      size_t const PatternOffset = J->ID * NumPatterns;
-      if (not NamesOnly)
+      std::vector<pkgCache::DescFileIterator> DescFiles;
+      for (size_t ID = 0; ID != descCount; ++ID)
       {
-         std::vector<std::string> PkgDescriptions;
-         for (auto &Desc: TranslatedDescriptionsList(J->V))
-         {
-            pkgRecords::Parser &parser = Recs.Lookup(Desc.FileList());
-            PkgDescriptions.push_back(parser.LongDesc());
-         }
-
-         std::vector<bool> SkipDescription(PkgDescriptions.size(), false);
-         for (unsigned I = 0; I < NumPatterns; ++I)
-         {
-            if (PatternMatch[PatternOffset + I])
-               continue;
-            else
-            {
-               bool found = false;
-
-               for (std::vector<std::string>::size_type k = 0; k < PkgDescriptions.size(); ++k)
-               {
-                  if (not SkipDescription[k])
-                  {
-                     if (regexec(&Patterns[I], PkgDescriptions[k].c_str(), 0, 0, 0) == 0)
-                     {
-                        found = true;
-                        PatternMatch[PatternOffset + I] = true;
-                     }
-                     else
-                        SkipDescription[k] = true;
-                  }
-               }
-
-               if (not found)
-                  break;
-            }
-         }
-      }
-
-      bool matchedAll = true;
-      for (unsigned I = 0; I < NumPatterns; ++I)
-	 if (PatternMatch[PatternOffset + I] == false)
+	 if (DFList[ID].Df == nullptr || NameMatchedAll(ID))
+	    continue;
+	 for (auto &Desc: TranslatedDescriptionsList(DFList[ID].V))
 	 {
-	    matchedAll = false;
-	    break;
+	    DescFiles.push_back(Desc.FileList());
+	    DescGroup.emplace(Desc.FileList(), ID);
 	 }
+      }
+      // one description has to match all patterns the name did not match
+      Recs.Lookup(std::move(DescFiles), [&](pkgCache::DescFileIterator const &Df, pkgRecords::Parser &Parser) {
+	 map_id_t const ID = DescGroup[Df];
+	 if (DescMatch[ID] == true)
+	    return true;
+	 std::string const LongDesc = Parser.LongDesc();
+	 size_t const PatternOffset = ID * NumPatterns;
+	 for (unsigned I = 0; I < NumPatterns; ++I)
+	    if (PatternMatch[PatternOffset + I] == false &&
+		regexec(&Patterns[I], LongDesc.c_str(), 0, 0, 0) != 0)
+	       return true;
+	 DescMatch[ID] = true;
+	 return true;
+      });
+   }
 
-      if (matchedAll == true)
+   // Print the matches, again in the order they are stored in
+   std::vector<pkgCache::DescFileIterator> Matches;
+   DescGroup.clear();
+   for (size_t ID = 0; ID != descCount; ++ID)
+   {
+      if (DFList[ID].Df == nullptr || (DescMatch[ID] == false && NameMatchedAll(ID) == false))
+	 continue;
+      Matches.emplace_back(*Cache, DFList[ID].Df);
+      DescGroup.emplace(DFList[ID].Df, ID);
+   }
+   Recs.Lookup(std::move(Matches), [&](pkgCache::DescFileIterator const &Df, pkgRecords::Parser &Parser) {
+      if (ShowFull == true)
       {
-	 if (ShowFull == true)
-	 {
-	    pkgCache::VerFileIterator Vf;
-	    auto &Parser = LookupParser(Recs, J->V, Vf);
-	    char const *Start, *Stop;
-	    Parser.GetRec(Start, Stop);
-	    size_t const Length = Stop - Start;
-	    DisplayRecordV1(CacheFile, Recs, J->V, Vf, Start, Length, std::cout);
-	 }
-	 else
-	 {
-	    pkgRecords::Parser &P = Recs.Lookup(pkgCache::DescFileIterator(*Cache, J->Df));
-	    printf("%s - %s\n", P.Name().c_str(), P.ShortDesc().c_str());
-	 }
+	 pkgCache::VerIterator const &V = DFList[DescGroup[Df]].V;
+	 pkgCache::VerFileIterator Vf;
+	 auto &VerParser = LookupParser(Recs, V, Vf);
+	 char const *Start, *Stop;
+	 VerParser.GetRec(Start, Stop);
+	 size_t const Length = Stop - Start;
+	 DisplayRecordV1(CacheFile, Recs, V, Vf, Start, Length, std::cout);
       }
-   }
-   
+      else
+	 printf("%s - %s\n", Parser.Name().c_str(), Parser.ShortDesc().c_str());
+      return true;
+   });
+
    delete [] DFList;
    delete [] PatternMatch;
    for (unsigned I = 0; I != NumPatterns; I++)
@@ -299,6 +299,8 @@ static bool DisplayRecordV2(pkgCacheFile &CacheFile, pkgRecords &Recs, /*{{{*/
 									/*}}}*/
 bool ShowPackage(CommandLine &CmdL)					/*{{{*/
 {
+   // we look only at the candidates and flags of the packages shown
+   _config->CndSet("APT::Cache::LazyDepCache", true);
    pkgCacheFile CacheFile;
    auto VolatileCmdL = GetAllPackagesAsPseudo(CacheFile.GetSourceList(), CmdL, AddVolatileBinaryFile, "");
 
@@ -42,6 +42,7 @@
 #include <apt-private/private-cmndline.h>
 #include <apt-private/private-depends.h>
 #include <apt-private/private-main.h>
+#include <apt-private/private-output.h>
 #include <apt-private/private-search.h>
 #include <apt-private/private-show.h>
 #include <apt-private/private-unmet.h>
@@ -239,7 +240,7 @@ static bool Stats(CommandLine &CmdL)
    cout << _("  Missing: ") << Missing << endl;
 
    cout << _("Total distinct versions: ") << Cache->Head().VersionCount << " (" <<
-      SizeToStr(Cache->Head().VersionCount*Cache->Head().VersionSz) << ')' << endl;
+      SizeToStr(Cache->Head().VersionCount*(Cache->Head().VersionSz + Cache->Head().VersionExtraSz)) << ')' << endl;
    cout << _("Total distinct descriptions: ") << Cache->Head().DescriptionCount << " (" <<
       SizeToStr(Cache->Head().DescriptionCount*Cache->Head().DescriptionSz) << ')' << endl;
    cout << _("Total dependencies: ") << Cache->Head().DependsCount << "/" << Cache->Head().DependsDataCount << " (" <<
@@ -319,6 +320,7 @@ static bool Stats(CommandLine &CmdL)
       APT_CACHESIZE(GroupCount, GroupSz) +
       APT_CACHESIZE(PackageCount, PackageSz) +
       APT_CACHESIZE(VersionCount, VersionSz) +
+      APT_CACHESIZE(VersionCount, VersionExtraSz) +
       APT_CACHESIZE(DescriptionCount, DescriptionSz) +
       APT_CACHESIZE(DependsCount, DependencySz) +
       APT_CACHESIZE(DependsDataCount, DependencyDataSz) +
@@ -392,9 +394,42 @@ static bool Dump(CommandLine &)
 // DumpAvail - Print out the available list				/*{{{*/
 // ---------------------------------------------------------------------
 /* This is needed to make dpkg --merge happy.. I spent a bit of time to 
-   make this run really fast, perhaps I went a little overboard.. */
+   make this run really fast, perhaps I went a little overboard..
+   With --format=json each record is printed as a JSON object on a line
+   of its own instead. */
+static void JsonRecordFromSection(std::string &Record, pkgTagSection const &Tags, bool const NotSource)
+{
+   Record.clear();
+   Record.push_back('{');
+   for (unsigned int I = 0; I < Tags.Count(); ++I)
+   {
+      const char *Start, *Stop;
+      Tags.Get(Start, Stop, I);
+      const char * const Colon = static_cast<const char *>(memchr(Start, ':', Stop - Start));
+      if (Colon == nullptr)
+	 continue;
+      APT::StringView const Name(Start, Colon - Start);
+      // the status file entries are written out as available entries, see below
+      if (NotSource == true && (Name == "Status" || Name == "Config-Version"))
+	 continue;
+      const char *Value = Colon + 1;
+      for (; Value < Stop && isspace_ascii(*Value) != 0; ++Value);
+      for (; Stop > Value && isspace_ascii(Stop[-1]) != 0; --Stop);
+      if (Record.size() != 1)
+	 Record.push_back(',');
+      AppendJsonString(Record, Name);
+      Record.push_back(':');
+      AppendJsonString(Record, APT::StringView(Value, Stop - Value));
+   }
+   Record.append("}\n");
+}
 static bool DumpAvail(CommandLine &)
 {
+   std::string const Format = _config->Find("APT::Cache::DumpAvail::Format", "deb822");
+   if (Format != "deb822" && Format != "json")
+      return _error->Error(_("Unknown output format '%s'"), Format.c_str());
+   bool const Json = Format == "json";
+
    pkgCacheFile CacheFile;
    pkgCache *Cache = CacheFile.GetPkgCache();
    if (unlikely(Cache == NULL || CacheFile.BuildPolicy() == false))
@@ -461,7 +496,8 @@ static bool DumpAvail(CommandLine &)
    RW.push_back(pkgTagSection::Tag::Remove("Status"));
    RW.push_back(pkgTagSection::Tag::Remove("Config-Version"));
    FileFd stdoutfd;
-   stdoutfd.OpenDescriptor(STDOUT_FILENO, FileFd::WriteOnly, false);
+   stdoutfd.OpenDescriptor(STDOUT_FILENO, FileFd::WriteOnly | FileFd::BufferedWrite, false);
+   std::string JsonRecord;
 
    // Iterate over all the package files and write them out.
    char *Buffer = new char[Cache->HeaderP->MaxVerFileSize+10];
@@ -499,8 +535,21 @@ static bool DumpAvail(CommandLine &)
 	    break;
 	 Buffer[VF.Size + Jitter] = '\n';
 
+	 if (Json == true)
+	 {
+	    pkgTagSection Tags;
+	    if (Tags.Scan(Buffer+Jitter,VF.Size+1) == false)
+	    {
+	       _error->Error("Internal Error, Unable to parse a package record");
+	       break;
+	    }
+	    bool const NotSource = (File->Flags & pkgCache::Flag::NotSource) == pkgCache::Flag::NotSource;
+	    JsonRecordFromSection(JsonRecord, Tags, NotSource);
+	    if (stdoutfd.Write(JsonRecord.data(), JsonRecord.size()) == false)
+	       break;
+	 }
 	 // See above..
-	 if ((File->Flags & pkgCache::Flag::NotSource) == pkgCache::Flag::NotSource)
+	 else if ((File->Flags & pkgCache::Flag::NotSource) == pkgCache::Flag::NotSource)
 	 {
 	    pkgTagSection Tags;
 	    if (Tags.Scan(Buffer+Jitter,VF.Size+1) == false ||
@@ -526,9 +575,26 @@ static bool DumpAvail(CommandLine &)
 
    delete [] Buffer;
    delete [] VFList;
+   stdoutfd.Close();
    return !_error->PendingError();
 }
 									/*}}}*/
+// DependencyCanBeMet - Check if any version or provides meets a dep	/*{{{*/
+static bool DependencyCanBeMet(pkgCache &Cache, pkgCache::DepIterator const &D)
+{
+   // Walk along the actual package providing versions
+   pkgCache::PkgIterator DPkg = D.TargetPkg();
+   for (pkgCache::VerIterator I = DPkg.VersionList(); I.end() == false; ++I)
+      if (Cache.VS->CheckDep(I.VerStr(),D->CompareOp,D.TargetVer()) == true)
+	 return true;
+
+   // Follow all provides
+   for (pkgCache::PrvIterator I = DPkg.ProvidesList(); I.end() == false; ++I)
+      if (Cache.VS->CheckDep(I.ProvideVersion(),D->CompareOp,D.TargetVer()) == false)
+	 return true;
+   return false;
+}
+									/*}}}*/
 // xvcg - Generate a graph for xvcg					/*{{{*/
 // ---------------------------------------------------------------------
 // Code contributed from Junichi Uekawa <dancer@debian.org> on 20 June 2002.
@@ -614,108 +680,90 @@ static bool XVcg(CommandLine &CmdL)
      "xmax: 700 ymax: 700 x: 30 y: 30" << endl <<
      "layout_downfactor: 8" << endl;
 
-   bool Act = true;
-   while (Act == true)
-   {
-      Act = false;
-      for (pkgCache::PkgIterator Pkg = Cache->PkgBegin(); Pkg.end() == false; ++Pkg)
-      {
-	 // See we need to show this package
-	 if (Show[Pkg->ID] == None || Show[Pkg->ID] >= DoneNR)
-	    continue;
-
-	 //printf ("node: { title: \"%s\" label: \"%s\" }\n", Pkg.Name(), Pkg.Name());
+   // Walk the graph starting from the packages to show
+   PackageGraphWalk Walk(*Cache);
+   for (pkgCache::PkgIterator Pkg = Cache->PkgBegin(); Pkg.end() == false; ++Pkg)
+      if (Show[Pkg->ID] != None)
+	 Walk.Push(Pkg);
+   Walk.Run([&](pkgCache::PkgIterator const &Pkg) {
+      // See we need to show this package
+      if (Show[Pkg->ID] == None || Show[Pkg->ID] >= DoneNR)
+	 return;
+
+      //printf ("node: { title: \"%s\" label: \"%s\" }\n", Pkg.Name(), Pkg.Name());
 	 
-	 // Colour as done
-	 if (Show[Pkg->ID] == ToShowNR || (Flags[Pkg->ID] & ForceNR) == ForceNR)
-	 {
-	    // Pure Provides and missing packages have no deps!
-	    if (ShapeMap[Pkg->ID] == 0 || ShapeMap[Pkg->ID] == 1)
-	       Show[Pkg->ID] = Done;
-	    else
-	       Show[Pkg->ID] = DoneNR;
-	 }	 
-	 else
+      // Colour as done
+      if (Show[Pkg->ID] == ToShowNR || (Flags[Pkg->ID] & ForceNR) == ForceNR)
+      {
+	 // Pure Provides and missing packages have no deps!
+	 if (ShapeMap[Pkg->ID] == 0 || ShapeMap[Pkg->ID] == 1)
 	    Show[Pkg->ID] = Done;
-	 Act = true;
+	 else
+	    Show[Pkg->ID] = DoneNR;
+      }	 
+      else
+	 Show[Pkg->ID] = Done;
 
-	 // No deps to map out
-	 if (Pkg->VersionList == 0 || Show[Pkg->ID] == DoneNR)
-	    continue;
+      // No deps to map out
+      if (Pkg->VersionList == 0 || Show[Pkg->ID] == DoneNR)
+	 return;
 	 
-	 pkgCache::VerIterator Ver = Pkg.VersionList();
-	 for (pkgCache::DepIterator D = Ver.DependsList(); D.end() == false; ++D)
+      pkgCache::VerIterator Ver = Pkg.VersionList();
+      for (pkgCache::DepIterator D = Ver.DependsList(); D.end() == false; ++D)
+      {
+	 // Only graph critical deps	    
+	 if (D.IsCritical() == true)
 	 {
-	    // See if anything can meet this dep
-	    // Walk along the actual package providing versions
-	    bool Hit = false;
-	    pkgCache::PkgIterator DPkg = D.TargetPkg();
-	    for (pkgCache::VerIterator I = DPkg.VersionList();
-		      I.end() == false && Hit == false; ++I)
-	    {
-	       if (Cache->VS->CheckDep(I.VerStr(),D->CompareOp,D.TargetVer()) == true)
-		  Hit = true;
-	    }
-	    
-	    // Follow all provides
-	    for (pkgCache::PrvIterator I = DPkg.ProvidesList(); 
-		      I.end() == false && Hit == false; ++I)
-	    {
-	       if (Cache->VS->CheckDep(I.ProvideVersion(),D->CompareOp,D.TargetVer()) == false)
-		  Hit = true;
-	    }
-	    
-
-	    // Only graph critical deps	    
-	    if (D.IsCritical() == true)
-	    {
-	       printf ("edge: { sourcename: \"%s\" targetname: \"%s\" class: 2 ",Pkg.FullName(true).c_str(), D.TargetPkg().FullName(true).c_str() );
+	    printf ("edge: { sourcename: \"%s\" targetname: \"%s\" class: 2 ",Pkg.FullName(true).c_str(), D.TargetPkg().FullName(true).c_str() );
 	       
-	       // Colour the node for recursion
-	       if (Show[D.TargetPkg()->ID] <= DoneNR)
+	    // Colour the node for recursion
+	    if (Show[D.TargetPkg()->ID] <= DoneNR)
+	    {
+	       auto const OldShow = Show[D.TargetPkg()->ID];
+	       /* If a conflicts does not meet anything in the database
+		  then show the relation but do not recurse */
+	       if (D.IsNegative() == true && DependencyCanBeMet(*Cache, D) == false)
+	       {
+		  if (Show[D.TargetPkg()->ID] == None && 
+		      Show[D.TargetPkg()->ID] != ToShow)
+		     Show[D.TargetPkg()->ID] = ToShowNR;
+	       }		  
+	       else
 	       {
-		  /* If a conflicts does not meet anything in the database
-		     then show the relation but do not recurse */
-		  if (Hit == false && D.IsNegative() == true)
-		  {
-		     if (Show[D.TargetPkg()->ID] == None && 
-			 Show[D.TargetPkg()->ID] != ToShow)
-			Show[D.TargetPkg()->ID] = ToShowNR;
-		  }		  
+		  if (GivenOnly == true && Show[D.TargetPkg()->ID] != ToShow)
+		     Show[D.TargetPkg()->ID] = ToShowNR;
 		  else
-		  {
-		     if (GivenOnly == true && Show[D.TargetPkg()->ID] != ToShow)
-			Show[D.TargetPkg()->ID] = ToShowNR;
-		     else
-			Show[D.TargetPkg()->ID] = ToShow;
-		  }
+		     Show[D.TargetPkg()->ID] = ToShow;
 	       }
+	       // packages still to show are in the frontier already
+	       if (Show[D.TargetPkg()->ID] != OldShow && (OldShow == None || OldShow == DoneNR))
+		  Walk.PushAgain(D.TargetPkg());
+	    }
 	       
-	       // Edge colour
-	       switch(D->Type)
-	       {
-		  case pkgCache::Dep::Conflicts:
-		    printf("label: \"conflicts\" color: lightgreen }\n");
-		    break;
-		  case pkgCache::Dep::DpkgBreaks:
-		    printf("label: \"breaks\" color: lightgreen }\n");
-		    break;
-		  case pkgCache::Dep::Obsoletes:
-		    printf("label: \"obsoletes\" color: lightgreen }\n");
-		    break;
+	    // Edge colour
+	    switch(D->Type)
+	    {
+	       case pkgCache::Dep::Conflicts:
+		 printf("label: \"conflicts\" color: lightgreen }\n");
+		 break;
+	       case pkgCache::Dep::DpkgBreaks:
+		 printf("label: \"breaks\" color: lightgreen }\n");
+		 break;
+	       case pkgCache::Dep::Obsoletes:
+		 printf("label: \"obsoletes\" color: lightgreen }\n");
+		 break;
 		  
-		  case pkgCache::Dep::PreDepends:
-		    printf("label: \"predepends\" color: blue }\n");
-		    break;
+	       case pkgCache::Dep::PreDepends:
+		 printf("label: \"predepends\" color: blue }\n");
+		 break;
 		  
-		  default:
-		    printf("}\n");
-		  break;
-	       }	       
-	    }	    
-	 }
+	       default:
+		 printf("}\n");
+	       break;
+	    }	       
+	 }	    
       }
-   }   
+   });
    
    /* Draw the box colours after the fact since we can not tell what colour
       they should be until everything is finished drawing */
@@ -827,101 +875,84 @@ static bool Dotty(CommandLine &CmdL)
    printf("concentrate=true;\n");
    printf("size=\"30,40\";\n");
    
-   bool Act = true;
-   while (Act == true)
-   {
-      Act = false;
-      for (pkgCache::PkgIterator Pkg = Cache->PkgBegin(); Pkg.end() == false; ++Pkg)
-      {
-	 // See we need to show this package
-	 if (Show[Pkg->ID] == None || Show[Pkg->ID] >= DoneNR)
-	    continue;
+   // Walk the graph starting from the packages to show
+   PackageGraphWalk Walk(*Cache);
+   for (pkgCache::PkgIterator Pkg = Cache->PkgBegin(); Pkg.end() == false; ++Pkg)
+      if (Show[Pkg->ID] != None)
+	 Walk.Push(Pkg);
+   Walk.Run([&](pkgCache::PkgIterator const &Pkg) {
+      // See we need to show this package
+      if (Show[Pkg->ID] == None || Show[Pkg->ID] >= DoneNR)
+	 return;
 	 
-	 // Colour as done
-	 if (Show[Pkg->ID] == ToShowNR || (Flags[Pkg->ID] & ForceNR) == ForceNR)
-	 {
-	    // Pure Provides and missing packages have no deps!
-	    if (ShapeMap[Pkg->ID] == 0 || ShapeMap[Pkg->ID] == 1)
-	       Show[Pkg->ID] = Done;
-	    else
-	       Show[Pkg->ID] = DoneNR;
-	 }	 
-	 else
+      // Colour as done
+      if (Show[Pkg->ID] == ToShowNR || (Flags[Pkg->ID] & ForceNR) == ForceNR)
+      {
+	 // Pure Provides and missing packages have no deps!
+	 if (ShapeMap[Pkg->ID] == 0 || ShapeMap[Pkg->ID] == 1)
 	    Show[Pkg->ID] = Done;
-	 Act = true;
+	 else
+	    Show[Pkg->ID] = DoneNR;
+      }	 
+      else
+	 Show[Pkg->ID] = Done;
 
-	 // No deps to map out
-	 if (Pkg->VersionList == 0 || Show[Pkg->ID] == DoneNR)
-	    continue;
+      // No deps to map out
+      if (Pkg->VersionList == 0 || Show[Pkg->ID] == DoneNR)
+	 return;
 	 
-	 pkgCache::VerIterator Ver = Pkg.VersionList();
-	 for (pkgCache::DepIterator D = Ver.DependsList(); D.end() == false; ++D)
+      pkgCache::VerIterator Ver = Pkg.VersionList();
+      for (pkgCache::DepIterator D = Ver.DependsList(); D.end() == false; ++D)
+      {
+	 // Only graph critical deps	    
+	 if (D.IsCritical() == true)
 	 {
-	    // See if anything can meet this dep
-	    // Walk along the actual package providing versions
-	    bool Hit = false;
-	    pkgCache::PkgIterator DPkg = D.TargetPkg();
-	    for (pkgCache::VerIterator I = DPkg.VersionList();
-		      I.end() == false && Hit == false; ++I)
-	    {
-	       if (Cache->VS->CheckDep(I.VerStr(),D->CompareOp,D.TargetVer()) == true)
-		  Hit = true;
-	    }
-	    
-	    // Follow all provides
-	    for (pkgCache::PrvIterator I = DPkg.ProvidesList(); 
-		      I.end() == false && Hit == false; ++I)
-	    {
-	       if (Cache->VS->CheckDep(I.ProvideVersion(),D->CompareOp,D.TargetVer()) == false)
-		  Hit = true;
-	    }
-	    
-	    // Only graph critical deps	    
-	    if (D.IsCritical() == true)
-	    {
-	       printf("\"%s\" -> \"%s\"",Pkg.FullName(true).c_str(),D.TargetPkg().FullName(true).c_str());
+	    printf("\"%s\" -> \"%s\"",Pkg.FullName(true).c_str(),D.TargetPkg().FullName(true).c_str());
 	       
-	       // Colour the node for recursion
-	       if (Show[D.TargetPkg()->ID] <= DoneNR)
+	    // Colour the node for recursion
+	    if (Show[D.TargetPkg()->ID] <= DoneNR)
+	    {
+	       auto const OldShow = Show[D.TargetPkg()->ID];
+	       /* If a conflicts does not meet anything in the database
+		  then show the relation but do not recurse */
+	       if (D.IsNegative() == true && DependencyCanBeMet(*Cache, D) == false)
 	       {
-		  /* If a conflicts does not meet anything in the database
-		     then show the relation but do not recurse */
-		  if (Hit == false && D.IsNegative() == true)
-		  {
-		     if (Show[D.TargetPkg()->ID] == None && 
-			 Show[D.TargetPkg()->ID] != ToShow)
-			Show[D.TargetPkg()->ID] = ToShowNR;
-		  }		  
+		  if (Show[D.TargetPkg()->ID] == None && 
+		      Show[D.TargetPkg()->ID] != ToShow)
+		     Show[D.TargetPkg()->ID] = ToShowNR;
+	       }		  
+	       else
+	       {
+		  if (GivenOnly == true && Show[D.TargetPkg()->ID] != ToShow)
+		     Show[D.TargetPkg()->ID] = ToShowNR;
 		  else
-		  {
-		     if (GivenOnly == true && Show[D.TargetPkg()->ID] != ToShow)
-			Show[D.TargetPkg()->ID] = ToShowNR;
-		     else
-			Show[D.TargetPkg()->ID] = ToShow;
-		  }
+		     Show[D.TargetPkg()->ID] = ToShow;
 	       }
+	       // packages still to show are in the frontier already
+	       if (Show[D.TargetPkg()->ID] != OldShow && (OldShow == None || OldShow == DoneNR))
+		  Walk.PushAgain(D.TargetPkg());
+	    }
 	       
-	       // Edge colour
-	       switch(D->Type)
-	       {
-		  case pkgCache::Dep::Conflicts:
-		  case pkgCache::Dep::Obsoletes:
-		  case pkgCache::Dep::DpkgBreaks:
-		  printf("[color=springgreen];\n");
-		  break;
+	    // Edge colour
+	    switch(D->Type)
+	    {
+	       case pkgCache::Dep::Conflicts:
+	       case pkgCache::Dep::Obsoletes:
+	       case pkgCache::Dep::DpkgBreaks:
+	       printf("[color=springgreen];\n");
+	       break;
 		  
-		  case pkgCache::Dep::PreDepends:
-		  printf("[color=blue];\n");
-		  break;
+	       case pkgCache::Dep::PreDepends:
+	       printf("[color=blue];\n");
+	       break;
 		  
-		  default:
-		  printf(";\n");
-		  break;
-	       }	       
-	    }	    
-	 }
+	       default:
+	       printf(";\n");
+	       break;
+	    }	       
+	 }	    
       }
-   }   
+   });
    
    /* Draw the box colours after the fact since we can not tell what colour
       they should be until everything is finished drawing */
@@ -949,6 +980,8 @@ static bool Dotty(CommandLine &CmdL)
 /* ShowAuto - show automatically installed packages (sorted)		{{{*/
 static bool ShowAuto(CommandLine &)
 {
+   // only the flags are needed, so no need to compute all states
+   _config->CndSet("APT::Cache::LazyDepCache", true);
    pkgCacheFile CacheFile;
    pkgCache *Cache = CacheFile.GetPkgCache();
    pkgDepCache *DepCache = CacheFile.GetDepCache();
@@ -979,34 +1012,24 @@ static bool ShowPkgNames(CommandLine &CmdL)
    pkgCacheFile CacheFile;
    if (unlikely(CacheFile.BuildCaches(NULL, false) == false))
       return false;
-   pkgCache::GrpIterator I = CacheFile.GetPkgCache()->GrpBegin();
+   pkgCache * const Cache = CacheFile.GetPkgCache();
    bool const All = _config->FindB("APT::Cache::AllNames","false");
+   char const * const Prefix = CmdL.FileList[1] != 0 ? CmdL.FileList[1] : "";
+   size_t const PrefixLen = strlen(Prefix);
 
-   if (CmdL.FileList[1] != 0)
-   {
-      for (;I.end() != true; ++I)
-      {
-	 if (All == false && I->FirstPackage == 0)
-	    continue;
-	 if (I.FindPkg("any")->VersionList == 0)
-	    continue;
-	 if (strncmp(I.Name(),CmdL.FileList[1],strlen(CmdL.FileList[1])) == 0)
-	    cout << I.Name() << endl;
-      }
-
-      return true;
-   }
-   
-   // Show all pkgs
-   for (;I.end() != true; ++I)
+   // the sorted list gives us all names starting with the prefix ignoring case
+   auto const Groups = Cache->FindGrpPrefix(Prefix);
+   for (auto G = Groups.first; G != Groups.second; ++G)
    {
+      pkgCache::GrpIterator I(*Cache, Cache->GrpP + *G);
       if (All == false && I->FirstPackage == 0)
 	 continue;
       if (I.FindPkg("any")->VersionList == 0)
 	 continue;
-      cout << I.Name() << endl;
+      if (strncmp(I.Name(), Prefix, PrefixLen) == 0)
+	 cout << I.Name() << endl;
    }
-   
+
    return true;
 }
 									/*}}}*/
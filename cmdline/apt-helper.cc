@@ -21,6 +21,7 @@
 
 #include <apt-pkg/srvrec.h>
 #include <apt-private/acqprogress.h>
+#include <apt-private/private-cache-proxy.h>
 #include <apt-private/private-cmndline.h>
 #include <apt-private/private-download.h>
 #include <apt-private/private-main.h>
@@ -310,6 +311,7 @@ static std::vector<aptDispatchWithHelp> GetCommands()			/*{{{*/
        {"drop-privs", &DropPrivsAndRun, _("drop privileges before running given command")},
        {"analyze-pattern", &AnalyzePattern, _("analyse a pattern")},
        {"analyse-pattern", &AnalyzePattern, nullptr},
+       {"cache-proxy", &DoCacheProxy, _("run a caching proxy for repositories")},
        {nullptr, nullptr, nullptr}};
 }
 									/*}}}*/
@@ -261,6 +261,8 @@ static bool DoMinimize(CommandLine &CmdL)
 /* ShowAuto - show automatically installed packages (sorted)		{{{*/
 static bool ShowAuto(CommandLine &CmdL)
 {
+   // only the flags are needed, so no need to compute all states
+   _config->CndSet("APT::Cache::LazyDepCache", true);
    pkgCacheFile CacheFile;
    pkgDepCache * const DepCache = CacheFile.GetDepCache();
    if (unlikely(DepCache == nullptr))
@@ -19,19 +19,25 @@
 #include <apt-pkg/hashes.h>
 #include <apt-pkg/strutl.h>
 
+#include <iostream>
+
 #include <ctype.h>
 #include <netinet/in.h> // htonl, etc
 #include <stddef.h>
 #include <strings.h>
 #include <sys/stat.h>
 
+#ifdef HAVE_LMDB
+#include <lmdb.h>
+#endif
+
 #include "cachedb.h"
 
 #include <apti18n.h>
 									/*}}}*/
 
 CacheDB::CacheDB(std::string const &DB)
-   : Dbp(0), Fd(NULL), DebFile(0)
+   : Dbp(0), Env(0), Txn(0), Dbi(0), TxnPuts(0), TxnBatch(0), Fd(NULL), DebFile(0)
 {
    TmpKey[0]='\0';
    ReadyDB(DB);
@@ -52,14 +58,16 @@ bool CacheDB::ReadyDB(std::string const &DB)
    int err;
 
    ReadOnly = _config->FindB("APT::FTPArchive::ReadOnlyDB",false);
-   
+   bool const Failed = DBFailed();
+
    // Close the old DB
    if (Dbp != 0) 
       Dbp->close(Dbp,0);
+   CloseLMDB();
    
    /* Check if the DB was disabled while running and deal with a 
       corrupted DB */
-   if (DBFailed() == true)
+   if (Failed == true)
    {
       _error->Warning(_("DB was corrupted, file renamed to %s.old"),DBFile.c_str());
       rename(DBFile.c_str(),(DBFile+".old").c_str());
@@ -72,6 +80,9 @@ bool CacheDB::ReadyDB(std::string const &DB)
    if (DB.empty())
       return true;
 
+   if (APT::String::Endswith(DB, ".lmdb") == true)
+      return ReadyLMDB(DB);
+
    db_create(&Dbp, NULL, 0);
    if ((err = Dbp->open(Dbp, NULL, DB.c_str(), NULL, DB_BTREE,
                         (ReadOnly?DB_RDONLY:DB_CREATE),
@@ -104,6 +115,168 @@ bool CacheDB::ReadyDB(std::string const &DB)
    return true;
 }
 									/*}}}*/
+// CacheDB::ReadyLMDB - Ready a LMDB database				/*{{{*/
+// ---------------------------------------------------------------------
+/* Databases named *.lmdb are kept in a memory mapped LMDB file instead of
+   BDB. Reads are served straight from the map and can happen concurrently
+   from multiple processes, writes are collected into a transaction which
+   is committed every APT::FTPArchive::LMDB::BatchSize records. */
+bool CacheDB::ReadyLMDB(std::string const &DB)
+{
+#ifdef HAVE_LMDB
+   int err;
+   size_t const MapSize = _config->FindI("APT::FTPArchive::LMDB::MapSize", sizeof(size_t) > 4 ? 4096 : 512);
+   TxnBatch = _config->FindI("APT::FTPArchive::LMDB::BatchSize", 1000);
+   TxnPuts = 0;
+
+   if ((err = mdb_env_create(&Env)) != 0 ||
+       (err = mdb_env_set_mapsize(Env, MapSize * 1024 * 1024)) != 0 ||
+       (err = mdb_env_open(Env, DB.c_str(), MDB_NOSUBDIR | (ReadOnly ? MDB_RDONLY : 0), 0644)) != 0 ||
+       (err = mdb_txn_begin(Env, NULL, ReadOnly ? MDB_RDONLY : 0, &Txn)) != 0 ||
+       (err = mdb_dbi_open(Txn, NULL, 0, &Dbi)) != 0)
+   {
+      CloseLMDB();
+      return _error->Error(_("Unable to open DB file %s: %s"),DB.c_str(), mdb_strerror(err));
+   }
+
+   DBFile = DB;
+   DBLoaded = true;
+   return true;
+#else
+   return _error->Error(_("Unable to open DB file %s: %s"), DB.c_str(), "LMDB support is not compiled in");
+#endif
+}
+									/*}}}*/
+// CacheDB::CommitLMDB - Commit the pending LMDB transaction		/*{{{*/
+// ---------------------------------------------------------------------
+/* If Renew is set, a new transaction is started for further accesses */
+bool CacheDB::CommitLMDB(bool const &Renew APT_UNUSED)
+{
+#ifdef HAVE_LMDB
+   if (Txn == 0)
+      return true;
+
+   int err = mdb_txn_commit(Txn);
+   Txn = 0;
+   TxnPuts = 0;
+   if (err == 0 && Renew == true)
+      err = mdb_txn_begin(Env, NULL, ReadOnly ? MDB_RDONLY : 0, &Txn);
+   if (err != 0)
+   {
+      Txn = 0;
+      DBLoaded = false;
+      errno = err;
+      return false;
+   }
+#endif
+   return true;
+}
+									/*}}}*/
+// CacheDB::CloseLMDB - Write back and close a LMDB database		/*{{{*/
+void CacheDB::CloseLMDB()
+{
+#ifdef HAVE_LMDB
+   if (Txn != 0)
+   {
+      if (DBLoaded == true)
+	 CommitLMDB(false);
+      else
+	 mdb_txn_abort(Txn);
+      Txn = 0;
+   }
+   if (Env != 0)
+      mdb_env_close(Env);
+#endif
+   Env = 0;
+   TxnPuts = 0;
+}
+									/*}}}*/
+// CacheDB::Get - Lookup the current key				/*{{{*/
+// ---------------------------------------------------------------------
+/* For LMDB the BDB semantics are emulated: Data.size is always set to the
+   size of the record and DB_DBT_USERMEM requests are copied out. */
+bool CacheDB::Get()
+{
+   if (Env == 0)
+      return Dbp->get(Dbp,0,&Key,&Data,0) == 0;
+#ifdef HAVE_LMDB
+   if (Txn == 0)
+      return false;
+   MDB_val K, D;
+   K.mv_size = Key.size;
+   K.mv_data = Key.data;
+   if (mdb_get(Txn, Dbi, &K, &D) != 0)
+      return false;
+
+   Data.size = D.mv_size;
+   if ((Data.flags & DB_DBT_USERMEM) == DB_DBT_USERMEM)
+   {
+      if (D.mv_size > Data.ulen)
+	 return false;
+      memcpy(Data.data, D.mv_data, D.mv_size);
+   }
+   else
+      Data.data = D.mv_data;
+   return true;
+#else
+   return false;
+#endif
+}
+									/*}}}*/
+// CacheDB::Put - Store data for the current key			/*{{{*/
+bool CacheDB::Put(const void *In,unsigned long const &Length)
+{
+   if (ReadOnly == true)
+      return true;
+   Data.size = Length;
+   Data.data = (void *)In;
+   if (DBLoaded == false)
+      return true;
+
+   if (Env == 0)
+   {
+      if ((errno = Dbp->put(Dbp,0,&Key,&Data,0)) != 0)
+      {
+	 DBLoaded = false;
+	 return false;
+      }
+      return true;
+   }
+#ifdef HAVE_LMDB
+   MDB_val K, D;
+   K.mv_size = Key.size;
+   K.mv_data = Key.data;
+   D.mv_size = Length;
+   D.mv_data = (void *)In;
+   int err = mdb_put(Txn, Dbi, &K, &D, 0);
+   if (err == MDB_MAP_FULL)
+   {
+      /* The records of the aborted batch are lost, but that is fine as
+	 missing records are simply regenerated on the next lookup */
+      mdb_txn_abort(Txn);
+      Txn = 0;
+      TxnPuts = 0;
+      MDB_envinfo Info;
+      if ((err = mdb_env_info(Env, &Info)) == 0 &&
+	  (err = mdb_env_set_mapsize(Env, Info.me_mapsize * 2)) == 0 &&
+	  (err = mdb_txn_begin(Env, NULL, 0, &Txn)) == 0)
+	 err = mdb_put(Txn, Dbi, &K, &D, 0);
+   }
+   if (err != 0)
+   {
+      if (Txn != 0)
+	 mdb_txn_abort(Txn);
+      Txn = 0;
+      DBLoaded = false;
+      errno = err;
+      return false;
+   }
+   if (++TxnPuts >= TxnBatch)
+      return CommitLMDB(true);
+#endif
+   return true;
+}
+									/*}}}*/
 // CacheDB::OpenFile - Open the file					/*{{{*/
 // ---------------------------------------------------------------------
 /* */
@@ -530,6 +703,20 @@ bool CacheDB::Finish()
    return true;
 }
 									/*}}}*/
+// IsValidKey - Check if a key belongs to an existing file		/*{{{*/
+static bool IsValidKey(const char *Key, size_t const Size)
+{
+   const char *Colon = (char*)memrchr(Key, ':', Size);
+   if (Colon == NULL)
+      return false;
+   if (stringcmp(Colon + 1, Key + Size,"st") != 0 &&
+       stringcmp(Colon + 1, Key + Size,"cl") != 0 &&
+       stringcmp(Colon + 1, Key + Size,"cs") != 0 &&
+       stringcmp(Colon + 1, Key + Size,"cn") != 0)
+      return false;
+   return FileExists(std::string(Key, Colon));
+}
+									/*}}}*/
 // CacheDB::Clean - Clean the Database					/*{{{*/
 // ---------------------------------------------------------------------
 /* Tidy the database by removing files that no longer exist at all. */
@@ -538,6 +725,31 @@ bool CacheDB::Clean()
    if (DBLoaded == false)
       return true;
 
+   if (Env != 0)
+   {
+#ifdef HAVE_LMDB
+      MDB_cursor *Cursor;
+      if (Txn == 0 || mdb_cursor_open(Txn, Dbi, &Cursor) != 0)
+	 return _error->Error(_("Unable to get a cursor"));
+
+      MDB_val Key, Data;
+      while (mdb_cursor_get(Cursor, &Key, &Data, MDB_NEXT) == 0)
+      {
+	 if (IsValidKey((const char *)Key.mv_data, Key.mv_size) == false)
+	    mdb_cursor_del(Cursor, 0);
+      }
+      mdb_cursor_close(Cursor);
+
+      if(_config->FindB("Debug::APT::FTPArchive::Clean", false) == true)
+      {
+	 MDB_stat St;
+	 if (mdb_stat(Txn, Dbi, &St) == 0)
+	    std::clog << "LMDB: " << St.ms_entries << " entries in " << St.ms_leaf_pages << " leaf pages" << std::endl;
+      }
+      return CommitLMDB(true);
+#endif
+   }
+
    /* I'm not sure what VERSION_MINOR should be here.. 2.4.14 certainly
       needs the lower one and 2.7.7 needs the upper.. */
    DBC *Cursor;
@@ -550,20 +762,8 @@ bool CacheDB::Clean()
    memset(&Data,0,sizeof(Data));
    while ((errno = Cursor->c_get(Cursor,&Key,&Data,DB_NEXT)) == 0)
    {
-      const char *Colon = (char*)memrchr(Key.data, ':', Key.size);
-      if (Colon)
-      {
-         if (stringcmp(Colon + 1, (char *)Key.data+Key.size,"st") == 0 ||
-             stringcmp(Colon + 1, (char *)Key.data+Key.size,"cl") == 0 ||
-             stringcmp(Colon + 1, (char *)Key.data+Key.size,"cs") == 0 ||
-             stringcmp(Colon + 1, (char *)Key.data+Key.size,"cn") == 0)
-	 {
-            std::string FileName = std::string((const char *)Key.data,Colon);
-            if (FileExists(FileName) == true) {
-		continue;
-            }
-	 }
-      }
+      if (IsValidKey((const char *)Key.data, Key.size) == true)
+	 continue;
       Cursor->c_del(Cursor,0);
    }
    int res = Dbp->compact(Dbp, NULL, NULL, NULL, NULL, DB_FREE_SPACE, NULL);
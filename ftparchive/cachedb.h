@@ -25,6 +25,8 @@
 #include "sources.h"
 
 class FileFd;
+struct MDB_env;
+struct MDB_txn;
 
 
 class CacheDB
@@ -36,6 +38,12 @@ class CacheDB
    DBT Data;
    char TmpKey[600];
    DB *Dbp;
+   // LMDB state, used instead of Dbp for *.lmdb databases
+   MDB_env *Env;
+   MDB_txn *Txn;
+   unsigned int Dbi;
+   unsigned long TxnPuts;
+   unsigned long TxnBatch;
    bool DBLoaded;
    bool ReadOnly;
    std::string DBFile;
@@ -62,23 +70,12 @@ class CacheDB
       _InitQuery("cn");
    }
 
-   inline bool Get() 
-   {
-      return Dbp->get(Dbp,0,&Key,&Data,0) == 0;
-   };
-   inline bool Put(const void *In,unsigned long const &Length) 
-   {
-      if (ReadOnly == true)
-	 return true;
-      Data.size = Length;
-      Data.data = (void *)In;
-      if (DBLoaded == true && (errno = Dbp->put(Dbp,0,&Key,&Data,0)) != 0)
-      {
-	 DBLoaded = false;
-	 return false;
-      }
-      return true;
-   }
+   bool Get();
+   bool Put(const void *In,unsigned long const &Length);
+   bool ReadyLMDB(std::string const &DB);
+   bool CommitLMDB(bool const &Renew);
+   void CloseLMDB();
+
    bool OpenFile();
    void CloseFile();
 
@@ -168,7 +165,7 @@ class CacheDB
    } Stats;
    
    bool ReadyDB(std::string const &DB = "");
-   inline bool DBFailed() {return Dbp != 0 && DBLoaded == false;};
+   inline bool DBFailed() {return (Dbp != 0 || Env != 0) && DBLoaded == false;};
    inline bool Loaded() {return DBLoaded == true;};
    
    inline unsigned long long GetFileSize(void) {return CurStat.FileSize;}
@@ -584,7 +584,12 @@ int BaseHttpMethod::Loop()
 	    URI uri(Queue->Uri);
 	    _config->Set("Acquire::" + uri.Access + "::proxy::" + uri.Host, Queue->Proxy());
 	 }
-	 Server = CreateServerState(URI(Queue->Uri));
+	 ParkServer();
+	 Server = UnparkServer(URI(Queue->Uri));
+	 if (Server == nullptr)
+	    Server = CreateServerState(URI(Queue->Uri));
+	 else
+	    QueueBack = Queue;
 	 setPostfixForMethodNames(::URI(Queue->Uri).Host.c_str());
 	 AllowRedirect = ConfigFindB("AllowRedirect", true);
 	 PipelineDepth = ConfigFindI("Pipeline-Depth", 10);
@@ -623,6 +628,11 @@ int BaseHttpMethod::Loop()
       // Fill the pipeline.
       Fetch(0);
 
+      /* Items already on disk are finished by Fetch, which might leave us
+	 with nothing (or nothing for this server) to wait for */
+      if (Queue == nullptr || Queue == QueueBack)
+	 continue;
+
       RequestState Req(this, Server.get());
       // Fetch the next URL header data from the server.
       switch (Server->RunHeaders(Req, Queue->Uri))
@@ -874,6 +884,60 @@ unsigned long long BaseHttpMethod::FindMaximumObjectSizeInQueue() const	/*{{{*/
    return MaxSizeInQueue;
 }
 									/*}}}*/
+// BaseHttpMethod::ParkServer - Keep the current connection for later	/*{{{*/
+// ---------------------------------------------------------------------
+/* If the queue switches between hosts (Queue-Mode access, redirects to
+   mirrors, …) we would otherwise tear down a perfectly fine keep-alive
+   connection just to build it up again a few requests later. */
+void BaseHttpMethod::ParkServer()
+{
+   if (Server == nullptr)
+      return;
+   if (Server->Persistent == false || Server->IsOpen() == false)
+   {
+      Server = nullptr;
+      return;
+   }
+   auto const PoolSize = ConfigFindI("Connection-Pool", 4);
+   if (PoolSize <= 0)
+   {
+      Server = nullptr;
+      return;
+   }
+   // evict the connection which was idle the longest
+   while (IdleServers.size() >= static_cast<size_t>(PoolSize))
+      IdleServers.erase(IdleServers.begin());
+   IdleServers.push_back({std::move(Server), time(nullptr)});
+}
+									/*}}}*/
+// BaseHttpMethod::UnparkServer - Pick up an idle connection to Srv	/*{{{*/
+std::unique_ptr<ServerState> BaseHttpMethod::UnparkServer(URI const &Srv)
+{
+   auto const Now = time(nullptr);
+   auto const IdleTimeout = ConfigFindI("Connection-Pool::Idle-Timeout", 5);
+   std::unique_ptr<ServerState> Found;
+   for (auto I = IdleServers.begin(); I != IdleServers.end();)
+   {
+      // servers tend to close idle keep-alive connections quickly, so we
+      // rather connect again than run into a reset on the next request
+      if (Now - I->Since > IdleTimeout || I->Server->IsOpen() == false)
+      {
+	 I->Server->Close();
+	 I = IdleServers.erase(I);
+      }
+      else if (Found == nullptr && I->Server->Comp(Srv))
+      {
+	 Found = std::move(I->Server);
+	 I = IdleServers.erase(I);
+      }
+      else
+	 ++I;
+   }
+   if (Found != nullptr && Debug == true)
+      std::clog << "Reusing idle connection to " << Srv.Host << std::endl;
+   return Found;
+}
+									/*}}}*/
 BaseHttpMethod::BaseHttpMethod(std::string &&Binary, char const *const Ver, unsigned long const Flags) /*{{{*/
     : aptAuthConfMethod(std::move(Binary), Ver, Flags), Server(nullptr),
       AllowRedirect(false), Debug(false), PipelineDepth(10)
@@ -18,6 +18,7 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 #include <time.h>
 
 using std::cout;
@@ -123,6 +124,16 @@ class BaseHttpMethod : public aptAuthConfMethod
    std::unique_ptr<ServerState> Server;
    std::string NextURI;
 
+   /** \brief persistent connections to other hosts we can switch back to */
+   struct IdleServerState
+   {
+      std::unique_ptr<ServerState> Server;
+      time_t Since;
+   };
+   std::vector<IdleServerState> IdleServers;
+   void ParkServer();
+   std::unique_ptr<ServerState> UnparkServer(URI const &Srv);
+
    bool AllowRedirect;
 
    // Find the biggest item in the fetch queue for the checking of the maximum
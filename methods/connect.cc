@@ -22,11 +22,14 @@
 #include <gnutls/gnutls.h>
 #include <gnutls/x509.h>
 
+#include <iostream>
 #include <list>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -799,6 +802,105 @@ ResultState UnwrapSocks(std::string Host, int Port, URI Proxy, std::unique_ptr<M
    return ResultState::SUCCESSFUL;
 }
 									/*}}}*/
+// TLS session cache - resume sessions rather than full handshakes	/*{{{*/
+// ---------------------------------------------------------------------
+/* Session data is kept per host:port for all connections of this method
+   and if configured also stored in a file to be picked up by later runs.
+   The file contains session secrets, so it is only ever readable for us.
+   Other methods running in parallel store their sessions in the same file,
+   so it is re-read under a lock and only our own entry is changed. */
+static std::map<std::string, std::string> TlsSessions;
+static std::string TlsSessionsFile;
+static bool TlsSessionsLoaded = false;
+
+static void ReadTlsSessions(std::map<std::string, std::string> &Sessions)
+{
+   if (RealFileExists(TlsSessionsFile) == false)
+      return;
+   FileFd File;
+   if (File.Open(TlsSessionsFile, FileFd::ReadOnly) == false)
+      return;
+   std::string Line;
+   while (File.ReadLine(Line) == true)
+   {
+      auto const Space = Line.find(' ');
+      if (Space == std::string::npos || Space == 0)
+	 continue;
+      APT::StringView const Hex(Line.c_str() + Space + 1, Line.length() - Space - 1);
+      std::string Data(Hex.length() / 2, '\0');
+      if (Data.empty() == true || Hex2Num(Hex, reinterpret_cast<unsigned char *>(&Data[0]), Data.length()) == false)
+	 continue;
+      Sessions[Line.substr(0, Space)] = std::move(Data);
+   }
+}
+static void LoadTlsSessions(aptMethod *const Owner)
+{
+   if (TlsSessionsLoaded == true)
+      return;
+   TlsSessionsLoaded = true;
+   TlsSessionsFile = Owner->ConfigFind("Session-Cache-File", "");
+   if (TlsSessionsFile.empty() == true)
+      return;
+
+   _error->PushToStack();
+   ReadTlsSessions(TlsSessions);
+   _error->RevertToStack();
+}
+static void SaveTlsSession(std::string const &Key)
+{
+   if (TlsSessionsFile.empty() == true)
+      return;
+
+   std::string const LockFile = TlsSessionsFile + ".lock";
+   int const LockFd = open(LockFile.c_str(), O_RDWR | O_CREAT | O_NOFOLLOW | O_CLOEXEC, 0600);
+   if (LockFd == -1)
+      return;
+   struct flock fl;
+   memset(&fl, 0, sizeof(fl));
+   fl.l_type = F_WRLCK;
+   fl.l_whence = SEEK_SET;
+   while (fcntl(LockFd, F_SETLKW, &fl) == -1)
+   {
+      if (errno != EINTR)
+      {
+	 close(LockFd);
+	 return;
+      }
+   }
+
+   _error->PushToStack();
+   std::map<std::string, std::string> Sessions;
+   ReadTlsSessions(Sessions);
+   auto const Session = TlsSessions.find(Key);
+   if (Session == TlsSessions.end())
+      Sessions.erase(Key);
+   else
+      Sessions[Key] = Session->second;
+
+   FileFd File;
+   if (File.Open(TlsSessionsFile, FileFd::WriteAtomic, 0600) == true)
+   {
+      static char const *const Digits = "0123456789abcdef";
+      std::string Line;
+      for (auto const &S : Sessions)
+      {
+	 Line = S.first;
+	 Line.append(1, ' ');
+	 for (unsigned char const C : S.second)
+	 {
+	    Line.append(1, Digits[C >> 4]);
+	    Line.append(1, Digits[C & 0xF]);
+	 }
+	 Line.append(1, '\n');
+	 if (File.Write(Line.data(), Line.length()) == false)
+	    break;
+      }
+      File.Close();
+   }
+   _error->RevertToStack();
+   close(LockFd);
+}
+									/*}}}*/
 // UnwrapTLS - Handle TLS connections 					/*{{{*/
 // ---------------------------------------------------------------------
 /* Performs a TLS handshake on the socket */
@@ -808,6 +910,8 @@ struct TlsFd : public MethodFd
    gnutls_session_t session;
    gnutls_certificate_credentials_t credentials;
    std::string hostname;
+   // host:port the session data is cached for, empty if not cacheable
+   std::string SessionKey;
    unsigned long Timeout;
 
    int Fd() APT_OVERRIDE { return UnderlyingFd->Fd(); }
@@ -880,8 +984,33 @@ struct TlsFd : public MethodFd
       return err;
    }
 
+   void RememberSession()
+   {
+      if (SessionKey.empty() == true)
+	 return;
+#if GNUTLS_VERSION_NUMBER >= 0x030603
+      // with TLS 1.3 resumption data is only usable once the server sent a ticket
+      if (gnutls_protocol_get_version(session) == GNUTLS_TLS1_3 &&
+	  (gnutls_session_get_flags(session) & GNUTLS_SFLAGS_SESSION_TICKET) == 0)
+	 return;
+#endif
+      gnutls_datum_t data;
+      if (gnutls_session_get_data2(session, &data) < 0)
+	 return;
+      std::string Data(reinterpret_cast<char const *>(data.data), data.size);
+      gnutls_free(data.data);
+      auto &Cached = TlsSessions[SessionKey];
+      if (Cached == Data)
+	 return;
+      Cached = std::move(Data);
+      SaveTlsSession(SessionKey);
+   }
+
    int Close() APT_OVERRIDE
    {
+      // a response was read by now, so TLS 1.3 tickets should have arrived
+      RememberSession();
+      SessionKey.clear();
       auto err = HandleError(gnutls_bye(session, GNUTLS_SHUT_RDWR));
       auto lower = UnderlyingFd->Close();
       return err < 0 ? HandleError(err) : lower;
@@ -893,7 +1022,7 @@ struct TlsFd : public MethodFd
    }
 };
 
-ResultState UnwrapTLS(std::string const &Host, std::unique_ptr<MethodFd> &Fd,
+ResultState UnwrapTLS(std::string const &Host, int const Port, std::unique_ptr<MethodFd> &Fd,
 		      unsigned long Timeout, aptMethod *Owner)
 {
    if (_config->FindB("Acquire::AllowTLS", true) == false)
@@ -1019,7 +1148,20 @@ ResultState UnwrapTLS(std::string const &Host, std::unique_ptr<MethodFd> &Fd,
 
    if (Owner->ConfigFindB("Verify-Peer", true))
    {
-      gnutls_session_set_verify_cert(tlsFd->session, Owner->ConfigFindB("Verify-Host", true) ? tlsFd->hostname.c_str() : nullptr, 0);
+      bool const VerifyHost = Owner->ConfigFindB("Verify-Host", true);
+      gnutls_session_set_verify_cert(tlsFd->session, VerifyHost ? tlsFd->hostname.c_str() : nullptr, 0);
+
+      // A resumed session skips the certificate checks, so only sessions
+      // which were fully verified in the first place are ever reused.
+      if (VerifyHost && Owner->ConfigFindB("Session-Resumption", true))
+      {
+	 LoadTlsSessions(Owner);
+	 strprintf(tlsFd->SessionKey, "%s:%d", tlsFd->hostname.c_str(), Port);
+	 auto const Cached = TlsSessions.find(tlsFd->SessionKey);
+	 if (Cached != TlsSessions.end() &&
+	     gnutls_session_set_data(tlsFd->session, Cached->second.data(), Cached->second.size()) < 0)
+	    TlsSessions.erase(Cached);
+      }
    }
 
    // set SNI only if the hostname is really a name and not an address
@@ -1045,7 +1187,16 @@ ResultState UnwrapTLS(std::string const &Host, std::unique_ptr<MethodFd> &Fd,
    err = tlsFd->DoTLSHandshake();
 
    if (err < 0)
+   {
+      // a session which failed to resume is not tried again by the next run
+      if (TlsSessions.erase(tlsFd->SessionKey) != 0)
+	 SaveTlsSession(tlsFd->SessionKey);
+      tlsFd->SessionKey.clear();
       return ResultState::FATAL_ERROR;
+   }
+
+   if (Owner->DebugEnabled() && gnutls_session_is_resumed(tlsFd->session) != 0)
+      std::clog << "Resumed TLS session with " << tlsFd->SessionKey << std::endl;
 
    return ResultState::SUCCESSFUL;
 }
@@ -517,7 +517,7 @@ ResultState HttpServerState::Open()
 	 return result;
       if (Host == Proxy.Host && Proxy.Access == "https")
       {
-	 result = UnwrapTLS(Proxy.Host, ServerFd, TimeOut, Owner);
+	 result = UnwrapTLS(Proxy.Host, Port, ServerFd, TimeOut, Owner);
 	 if (result != ResultState::SUCCESSFUL)
 	    return result;
       }
@@ -530,7 +530,7 @@ ResultState HttpServerState::Open()
    }
 
    if (tls)
-      return UnwrapTLS(ServerName.Host, ServerFd, TimeOut, Owner);
+      return UnwrapTLS(ServerName.Host, ServerName.Port == 0 ? DefaultPort : ServerName.Port, ServerFd, TimeOut, Owner);
 
    return ResultState::SUCCESSFUL;
 }
@@ -19,12 +19,20 @@
 #include <apt-pkg/sourcelist.h>
 #include <apt-pkg/strutl.h>
 
+#include <chrono>
 #include <functional>
 #include <random>
 #include <string>
 #include <unordered_map>
 
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
 #include <sys/utsname.h>
+#include <unistd.h>
 
 #include <apti18n.h>
 									/*}}}*/
@@ -54,6 +62,8 @@ class MirrorMethod : public aptMethod /*{{{*/
    {
       std::string uri;
       unsigned long priority = std::numeric_limits<decltype(priority)>::max();
+      // time in msec it took to connect to the mirror if it was probed
+      unsigned long latency = std::numeric_limits<decltype(latency)>::max();
       decltype(genrng)::result_type seed = 0;
       std::unordered_map<std::string, std::vector<std::string>> tags;
       explicit MirrorInfo(std::string const &u, std::vector<std::string> &&ptags = {}) : uri(u)
@@ -92,14 +102,36 @@ class MirrorMethod : public aptMethod /*{{{*/
    virtual bool URIAcquire(std::string const &Message, FetchItem *Itm) APT_OVERRIDE;
 
    void RedirectItem(MirrorListInfo const &info, FetchItem *const Itm, std::string const &Message);
+   void ProbeMirrors(MirrorListInfo &info);
    bool MirrorListFileRecieved(MirrorListInfo &info, FetchItem *const Itm);
    std::string GetMirrorFileURI(std::string const &Message, FetchItem *const Itm);
    void DealWithPendingItems(std::vector<std::string> const &baseuris, MirrorListInfo const &info, FetchItem *const Itm, std::function<void()> handler);
 
    public:
+   virtual bool Configuration(std::string Message) APT_OVERRIDE
+   {
+      if (pkgAcqMethod::Configuration(Message) == false)
+	 return false;
+
+      std::string const conf = std::string("Binary::") + Binary;
+      _config->MoveSubTree(conf.c_str(), NULL);
+
+      // probing needs to connect to the mirrors, so allow it before sandboxing
+      if (ConfigFindB("Probe", false))
+	 SeccompFlags |= aptMethod::NETWORK;
+
+      DropPrivsOrDie();
+      if (LoadSeccomp() == false)
+	 return false;
+
+      return true;
+   }
+
    explicit MirrorMethod(std::string &&pProg) : aptMethod(std::move(pProg), "2.0", SingleInstance | Pipeline | SendConfig | AuxRequests), genrng(clock())
    {
       SeccompFlags = aptMethod::BASE | aptMethod::DIRECTORY;
+      if (Binary != "mirror")
+	 methodNames.insert(methodNames.begin(), "mirror");
    }
 };
 									/*}}}*/
@@ -140,6 +172,8 @@ void MirrorMethod::RedirectItem(MirrorListInfo const &info, FetchItem *const Itm
    std::sort(possMirrors.begin(), possMirrors.end(), [](MirrorInfo const &a, MirrorInfo const &b) {
       if (a.priority != b.priority)
 	 return a.priority < b.priority;
+      if (a.latency != b.latency)
+	 return a.latency < b.latency;
       return a.seed < b.seed;
    });
    std::string const path = Itm->Uri.substr(info.baseuri.length());
@@ -164,6 +198,131 @@ void MirrorMethod::RedirectItem(MirrorListInfo const &info, FetchItem *const Itm
    Dequeue();
 }
 									/*}}}*/
+void MirrorMethod::ProbeMirrors(MirrorListInfo &info)			/*{{{*/
+{
+   /* Connect to all mirrors at the same time and order mirrors of the same
+      priority by the time it took to establish the connection. Only plain
+      network access types are probed as e.g. tor+http should not be contacted
+      directly and a mirror behind a proxy can't be measured this way. */
+   if (ConfigFindB("Probe", false) == false)
+      return;
+   auto const Timeout = std::chrono::milliseconds(ConfigFindI("Probe::Timeout", 500));
+   bool const Debug = DebugEnabled();
+
+   struct Probe
+   {
+      std::string Host;
+      std::string Port;
+      std::chrono::steady_clock::time_point Start;
+      unsigned long Latency = std::numeric_limits<unsigned long>::max();
+   };
+   std::vector<Probe> probes;
+   std::vector<size_t> mirrorprobe(info.list.size(), std::numeric_limits<size_t>::max());
+   for (size_t i = 0; i < info.list.size(); ++i)
+   {
+      ::URI const uri(info.list[i].uri);
+      if (uri.Access != "http" && uri.Access != "https" && uri.Access != "ftp")
+	 continue;
+      if (_config->Find("Acquire::" + uri.Access + "::Proxy").empty() == false ||
+	  getenv((uri.Access + "_proxy").c_str()) != nullptr)
+	 continue;
+      std::string const port = uri.Port != 0 ? std::to_string(uri.Port) : uri.Access;
+      auto const p = std::find_if(probes.begin(), probes.end(), [&](Probe const &p) {
+	 return p.Host == uri.Host && p.Port == port;
+      });
+      if (p != probes.end())
+      {
+	 mirrorprobe[i] = p - probes.begin();
+	 continue;
+      }
+      mirrorprobe[i] = probes.size();
+      Probe probe;
+      probe.Host = uri.Host;
+      probe.Port = port;
+      probes.push_back(std::move(probe));
+   }
+
+   /* resolving is done upfront so that it doesn't count against the connect.
+      All addresses of a host are raced against each other like a normal
+      connection would fall back to them, the first one connected counts. */
+   std::vector<struct pollfd> fds;
+   std::vector<size_t> fdprobe;
+   for (size_t p = 0; p < probes.size(); ++p)
+   {
+      auto &probe = probes[p];
+      struct addrinfo hints;
+      memset(&hints, 0, sizeof(hints));
+      hints.ai_socktype = SOCK_STREAM;
+      hints.ai_flags = AI_ADDRCONFIG;
+      struct addrinfo *addrs = nullptr;
+      if (getaddrinfo(probe.Host.c_str(), probe.Port.c_str(), &hints, &addrs) != 0 || addrs == nullptr)
+	 continue;
+      probe.Start = std::chrono::steady_clock::now();
+      for (auto addr = addrs; addr != nullptr; addr = addr->ai_next)
+      {
+	 int const Fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+	 if (Fd == -1)
+	    continue;
+	 SetNonBlock(Fd, true);
+	 if (connect(Fd, addr->ai_addr, addr->ai_addrlen) != 0 && errno != EINPROGRESS)
+	 {
+	    close(Fd);
+	    continue;
+	 }
+	 fds.push_back({Fd, POLLOUT, 0});
+	 fdprobe.push_back(p);
+      }
+      freeaddrinfo(addrs);
+   }
+
+   auto const Deadline = std::chrono::steady_clock::now() + Timeout;
+   size_t pending = fds.size();
+   while (pending != 0)
+   {
+      auto const Now = std::chrono::steady_clock::now();
+      if (Now >= Deadline)
+	 break;
+      auto const Wait = std::chrono::duration_cast<std::chrono::milliseconds>(Deadline - Now).count();
+      int const ready = poll(fds.data(), fds.size(), Wait);
+      if (ready < 0 && errno == EINTR)
+	 continue;
+      if (ready <= 0)
+	 break;
+      auto const Done = std::chrono::steady_clock::now();
+      for (size_t f = 0; f < fds.size(); ++f)
+      {
+	 auto &pfd = fds[f];
+	 if (pfd.fd < 0 || pfd.revents == 0)
+	    continue;
+	 auto &probe = probes[fdprobe[f]];
+	 int err = 0;
+	 socklen_t len = sizeof(err);
+	 if (getsockopt(pfd.fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0 &&
+	     probe.Latency == std::numeric_limits<unsigned long>::max())
+	    probe.Latency = std::chrono::duration_cast<std::chrono::milliseconds>(Done - probe.Start).count();
+	 close(pfd.fd);
+	 pfd.fd = -1;
+	 --pending;
+      }
+   }
+   for (auto const &pfd : fds)
+      if (pfd.fd != -1)
+	 close(pfd.fd);
+   if (Debug)
+   {
+      for (auto const &probe : probes)
+      {
+	 if (probe.Latency == std::numeric_limits<unsigned long>::max())
+	    std::clog << "Mirror-Probe: " << probe.Host << ':' << probe.Port << " failed" << std::endl;
+	 else
+	    std::clog << "Mirror-Probe: " << probe.Host << ':' << probe.Port << " connected in " << probe.Latency << "ms" << std::endl;
+      }
+   }
+   for (size_t i = 0; i < info.list.size(); ++i)
+      if (mirrorprobe[i] < probes.size())
+	 info.list[i].latency = probes[mirrorprobe[i]].Latency;
+}
+									/*}}}*/
 void MirrorMethod::DealWithPendingItems(std::vector<std::string> const &baseuris, /*{{{*/
 					MirrorListInfo const &info, FetchItem *const Itm,
 					std::function<void()> handler)
@@ -265,6 +424,7 @@ bool MirrorMethod::MirrorListFileRecieved(MirrorListInfo &info, FetchItem *const
       }
       else
       {
+	 ProbeMirrors(info);
 	 info.state = AVAILABLE;
 	 DealWithPendingItems(baseuris, info, Itm, [&]() {
 	    RedirectItem(info, Queue, msgCache[Queue->Uri]);
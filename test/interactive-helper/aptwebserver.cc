@@ -22,6 +22,7 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <list>
@@ -210,12 +211,16 @@ static bool sendFile(int const client, std::list<std::string> const &headers, Fi
 {
    bool Success = true;
    bool const chunked = chunkedTransferEncoding(headers);
+   // slow the download down to the given KiB/s per connection
+   unsigned long long const limit = _config->FindI("aptwebserver::dl-limit", 0) * 1024;
    char buffer[500];
    unsigned long long actual = 0;
    while ((Success &= data.Read(buffer, sizeof(buffer), &actual)) == true)
    {
       if (actual == 0)
 	 break;
+      if (limit != 0)
+	 std::this_thread::sleep_for(std::chrono::microseconds(actual * 1000 * 1000 / limit));
 
       if (chunked == true)
       {
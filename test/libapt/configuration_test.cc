@@ -232,3 +232,77 @@ List::Option2 { "Multi";
    EXPECT_TRUE(Cnf.FindB("Trailing"));
    EXPECT_FALSE(Cnf.Exists("Commented::Out"));
 }
+TEST(ConfigurationTest, Keys)
+{
+   Configuration::Key const Answer("Answer::Simple");
+   Configuration::Key const Mixed("answer::SIMPLE");
+   Configuration::Key const Missing("Answer::Missing");
+   Configuration::Key const Scope("Answer");
+   Configuration::Key const Trailing("Answer::");
+   EXPECT_EQ("Answer::Simple", Answer.FullName());
+
+   Configuration Cnf;
+   EXPECT_FALSE(Cnf.Exists(Answer));
+   EXPECT_EQ(7, Cnf.FindI(Answer, 7));
+   Cnf.Set("Answer::Simple", 42);
+   Cnf.Set("Answer::Bool", "yes");
+   EXPECT_TRUE(Cnf.Exists(Answer));
+   EXPECT_TRUE(Cnf.Exists(Scope));
+   EXPECT_FALSE(Cnf.Exists(Missing));
+   EXPECT_FALSE(Cnf.Exists(Trailing));
+   EXPECT_EQ(42, Cnf.FindI(Answer, 7));
+   EXPECT_EQ(42, Cnf.FindI(Mixed, 7));
+   EXPECT_EQ("42", Cnf.Find(Answer));
+   EXPECT_EQ("default", Cnf.Find(Missing, "default"));
+   EXPECT_TRUE(Cnf.FindB(Configuration::Key("ANSWER::bool")));
+
+   // keys are not bound to a configuration or its items
+   Configuration Other;
+   EXPECT_FALSE(Other.Exists(Answer));
+   Other.Set("answer::simple", 23);
+   EXPECT_EQ(23, Other.FindI(Answer));
+   EXPECT_EQ(42, Cnf.FindI(Answer));
+
+   Cnf.Clear("Answer");
+   EXPECT_FALSE(Cnf.Exists(Answer));
+   EXPECT_TRUE(Cnf.Exists(Scope));
+   Cnf.Set("Answer::Simple", 21);
+   EXPECT_EQ(21, Cnf.FindI(Mixed));
+
+   Cnf.MoveSubTree("Answer", "Question");
+   EXPECT_FALSE(Cnf.Exists(Answer));
+   EXPECT_EQ(21, Cnf.FindI(Configuration::Key("Question::Simple")));
+   Cnf.MoveSubTree("Question", nullptr);
+   EXPECT_EQ(21, Cnf.FindI(Configuration::Key("Simple")));
+}
+TEST(ConfigurationTest, ManyChildren)
+{
+   Configuration Cnf;
+   for (int i = 0; i < 1000; ++i)
+   {
+      std::string const name = "Many::Child" + std::to_string(i);
+      Cnf.Set(name.c_str(), i);
+      Cnf.Set("Many::List::", i);
+   }
+   for (int i = 0; i < 1000; i += 111)
+   {
+      std::string const name = "MANY::child" + std::to_string(i);
+      EXPECT_EQ(i, Cnf.FindI(name, -1));
+      EXPECT_EQ(i, Cnf.FindI(Configuration::Key(name), -1));
+   }
+   std::vector<std::string> const keys = Cnf.FindVector("Many", "", true);
+   ASSERT_EQ(1001u, keys.size());
+   EXPECT_EQ("Child0", keys[0]);
+   EXPECT_EQ("List", keys[1]);
+   EXPECT_EQ("Child1", keys[2]);
+   EXPECT_EQ("Child999", keys[1000]);
+
+   Cnf.Clear("Many::List", 0);
+   Cnf.Clear("Many::List", 999);
+   Cnf.Set("Many::List::", "last");
+   std::vector<std::string> const list = Cnf.FindVector("Many::List");
+   ASSERT_EQ(999u, list.size());
+   EXPECT_EQ("1", list[0]);
+   EXPECT_EQ("998", list[997]);
+   EXPECT_EQ("last", list[998]);
+}